@@ -49,6 +49,26 @@ void Actuator::reload()
   lastTimeActivated = 0;
 
   deployCounter = 0;
+
+  firstActivationTime = 0;
+  minimumPulseWidth = 0xFFFFFFFF;
+  maximumPulseWidth = 0;
+  numberOfPulses = 0;
+  isPinHigh = false;
+}
+
+void Actuator::turnOff(uint8_t pin)
+{
+  digitalWrite(pin, LOW);
+
+  if ( isPinHigh )
+  {
+    uint32_t width = micros() - lastRisingEdge;
+    if ( width < minimumPulseWidth ) minimumPulseWidth = width;
+    if ( width > maximumPulseWidth ) maximumPulseWidth = width;
+    numberOfPulses++;
+    isPinHigh = false;
+  }
 }
 
 bool Actuator::deployParachute(bool stopCondition)
@@ -82,6 +102,9 @@ bool Actuator::deploy(uint8_t pin, bool stopCondition)
   if ( deployCounter == 0 )
   {
     digitalWrite(pin, HIGH);
+    lastRisingEdge = micros();
+    firstActivationTime = lastRisingEdge;
+    isPinHigh = true;
     lastTimeActivated = currentTime;
     deployCounter++;
   }
@@ -93,13 +116,15 @@ bool Actuator::deploy(uint8_t pin, bool stopCondition)
       // If the stop condition is true, finishes the deployment cycle
       if ( stopCondition )
       {
-        digitalWrite(pin, LOW);
+        turnOff(pin);
         return true;
       }
       // Otherwise, starts another deployment cycle
       else
       {
         digitalWrite(pin, HIGH);
+        lastRisingEdge = micros();
+        isPinHigh = true;
         lastTimeActivated = currentTime;
         deployCounter++;
       }
@@ -107,7 +132,7 @@ bool Actuator::deploy(uint8_t pin, bool stopCondition)
     // If the actuator discharge time has bee elapsed, turn off the pin
     else if ( currentTime > ( lastTimeActivated + ParametersStatic::actuatorDischargeTime ) )
     {
-      digitalWrite(pin, LOW);
+      turnOff(pin);
     }
   }
   return false;
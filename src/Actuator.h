@@ -69,13 +69,34 @@ class Actuator
     */
     bool deploy(uint8_t pin, bool stopCondition);
 
+    // Registers the instant of the falling edge of the pin and the width of the pulse
+    void turnOff(uint8_t pin);
+
 public:
 
     uint8_t deployCounter {0};                // counts the number of activations
 
+    // Returns the instant of the first rising edge of the pin since the last reload (microseconds)
+    uint32_t getFirstActivationTime(){return firstActivationTime;};
+
+    // Returns the number of pulses finished since the last reload
+    uint8_t getNumberOfPulses(){return numberOfPulses;};
+
+    // Returns the minimum width of the pulses finished since the last reload (microseconds)
+    uint32_t getMinimumPulseWidth(){return ( numberOfPulses > 0 ? minimumPulseWidth : 0 );};
+
+    // Returns the maximum width of the pulses finished since the last reload (microseconds)
+    uint32_t getMaximumPulseWidth(){return maximumPulseWidth;};
+
   private:
 
     unsigned long int lastTimeActivated {0};  // last instant where the parachute or drogue chute was activated
+    uint32_t        firstActivationTime {0};  // instant of the first rising edge since the last reload (microseconds)
+    uint32_t             lastRisingEdge {0};  // instant of the last rising edge (microseconds)
+    uint32_t          minimumPulseWidth {0};  // minimum width of the pulses (microseconds)
+    uint32_t          maximumPulseWidth {0};  // maximum width of the pulses (microseconds)
+    uint8_t              numberOfPulses {0};  // number of pulses finished
+    bool                      isPinHigh {false}; // true if the pin is HIGH
 };
 
 #endif // ACTUATOR_H
@@ -42,7 +42,7 @@ Adafruit_BMP280::Adafruit_BMP280(TwoWire *theWire)
  */
 Adafruit_BMP280::Adafruit_BMP280(int8_t cspin, SPIClass *theSPI)
     : _cs(cspin), _mosi(-1), _miso(-1), _sck(-1) {
-  *_spi = *theSPI;
+  _spi = theSPI;
 }
 
 /*!
@@ -99,6 +99,23 @@ bool Adafruit_BMP280::begin(uint8_t addr, uint8_t chipid) {
   return true;
 }
 
+/*!
+ * @brief  Sets the clock of the hardware SPI bus
+ * @param  clock
+ *         SPI clock (Hz). The BMP280 supports up to 10 MHz.
+ */
+void Adafruit_BMP280::setSPIClock(uint32_t clock) { _spiClock = clock; }
+
+/*!
+ * @brief  Returns the raw ADC word of the last temperature reading
+ */
+int32_t Adafruit_BMP280::getRawTemperature() { return _rawTemperature; }
+
+/*!
+ * @brief  Returns the raw ADC word of the last pressure reading
+ */
+int32_t Adafruit_BMP280::getRawPressure() { return _rawPressure; }
+
 /*!
  * Sets the sampling config for the device.
  * @param mode
@@ -159,7 +176,7 @@ void Adafruit_BMP280::write8(byte reg, byte value) {
     _wire->endTransmission();
   } else {
     if (_sck == -1)
-      _spi->beginTransaction(SPISettings(500000, MSBFIRST, SPI_MODE0));
+      _spi->beginTransaction(SPISettings(_spiClock, MSBFIRST, SPI_MODE0));
     digitalWrite(_cs, LOW);
     spixfer(reg & ~0x80); // write, bit 7 low
     spixfer(value);
@@ -187,7 +204,7 @@ uint8_t Adafruit_BMP280::read8(byte reg) {
 
   } else {
     if (_sck == -1)
-      _spi->beginTransaction(SPISettings(500000, MSBFIRST, SPI_MODE0));
+      _spi->beginTransaction(SPISettings(_spiClock, MSBFIRST, SPI_MODE0));
     digitalWrite(_cs, LOW);
     spixfer(reg | 0x80); // read, bit 7 high
     value = spixfer(0);
@@ -213,7 +230,7 @@ uint16_t Adafruit_BMP280::read16(byte reg) {
 
   } else {
     if (_sck == -1)
-      _spi->beginTransaction(SPISettings(500000, MSBFIRST, SPI_MODE0));
+      _spi->beginTransaction(SPISettings(_spiClock, MSBFIRST, SPI_MODE0));
     digitalWrite(_cs, LOW);
     spixfer(reg | 0x80); // read, bit 7 high
     value = (spixfer(0) << 8) | spixfer(0);
@@ -259,7 +276,7 @@ uint32_t Adafruit_BMP280::read24(byte reg) {
 
   } else {
     if (_sck == -1)
-      _spi->beginTransaction(SPISettings(500000, MSBFIRST, SPI_MODE0));
+      _spi->beginTransaction(SPISettings(_spiClock, MSBFIRST, SPI_MODE0));
     digitalWrite(_cs, LOW);
     spixfer(reg | 0x80); // read, bit 7 high
 
@@ -305,6 +322,7 @@ float Adafruit_BMP280::readTemperature() {
 
   int32_t adc_T = read24(BMP280_REGISTER_TEMPDATA);
   adc_T >>= 4;
+  _rawTemperature = adc_T;
 
   var1 = ((((adc_T >> 3) - ((int32_t)_bmp280_calib.dig_T1 << 1))) *
           ((int32_t)_bmp280_calib.dig_T2)) >>
@@ -334,6 +352,7 @@ float Adafruit_BMP280::readPressure() {
 
   int32_t adc_P = read24(BMP280_REGISTER_PRESSUREDATA);
   adc_P >>= 4;
+  _rawPressure = adc_P;
 
   var1 = ((int64_t)t_fine) - 128000;
   var2 = var1 * var1 * (int64_t)_bmp280_calib.dig_P6;
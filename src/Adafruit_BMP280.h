@@ -177,6 +177,12 @@ public:
                    sensor_sampling pressSampling = SAMPLING_X16,
                    sensor_filter filter = FILTER_OFF,
                    standby_duration duration = STANDBY_MS_1);
+
+  void setSPIClock(uint32_t clock);
+
+  int32_t getRawTemperature();
+
+  int32_t getRawPressure();
   
   TwoWire *_wire; /**< Wire object */
   SPIClass *_spi; /**< SPI object */
@@ -224,6 +230,8 @@ private:
   int32_t _sensorID;
   int32_t t_fine;
   int8_t _cs, _mosi, _miso, _sck;
+  uint32_t _spiClock = 500000;
+  int32_t _rawTemperature = 0, _rawPressure = 0;
   bmp280_calib_data _bmp280_calib;
   config _configReg;
   ctrl_meas _measReg;
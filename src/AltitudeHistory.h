@@ -0,0 +1,204 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef ALTITUDEHISTORY_H
+#define ALTITUDEHISTORY_H
+
+#include <inttypes.h>
+
+/*
+
+  AltitudeHistory keeps the last 'length' altitudes in a circular buffer.
+
+  The altitudes are stored in decimeters as int16_t (-3276.8 m to 3276.7 m), the resolution of
+  the flight log. Altitudes out of this range are saturated. Conversions from and to meters 
+  are performed only when the altitudes enter and leave the buffer.
+
+  The buffer is indexed logically: element 0 is the oldest altitude and element length-1 is
+  the newest one. Pushing a new altitude overwrites the oldest one and moves the index of the
+  newest one, so that no element is shifted (O(1) per push).
+
+  The minimum and the maximum of the last 'window' altitudes (see setExtremaWindow) are
+  kept by two monotonic deques. The buffer holds the last max(length, maxWindow) altitudes,
+  so that both the logical elements and the window are available.
+
+*/
+
+/*
+  Note about the monotonic deques
+  -------------------------------
+
+  The deques store the indexes of the altitudes in the buffer instead of the altitudes. The 
+  maximum deque keeps decreasing altitudes from its front to its back: before the new altitude
+  is appended, the altitudes that are not greater than it are removed from the back, since they
+  can never be the maximum again. The altitude that leaves the window is removed from the front.
+  Hence, the front is always the maximum of the window. The minimum deque is analogous. Each 
+  altitude enters and leaves a deque once, so the cost is O(1) amortized per push, whatever the
+  length of the window. A deque never holds more than 'window' altitudes, so each one has room
+  for maxWindow indexes.
+
+  The indexes of the buffer and of the deques wrap around by a comparison instead of a mask,
+  so that their capacities need not be powers of 2.
+*/
+
+template <uint8_t length, uint8_t maxWindow>
+class AltitudeHistory
+{
+  public:
+
+    // Sets all elements to h (m)
+    void fill(float h)
+    {
+      int16_t dh = toDecimeters(h);
+      for (uint8_t i = 0; i < capacity; ++i)
+      {
+        values[i] = dh;
+      }
+      newest = capacity - 1;
+      rebuildExtrema();
+    }
+
+    // Discards the oldest altitude and appends h (m) as the newest one
+    void push(float h)
+    {
+      newest = wrap(newest + 1, capacity);
+      values[newest] = toDecimeters(h);
+      pushExtrema(newest);
+    }
+
+    // Returns the i-th of the last 'length' altitudes (m) (0 is the oldest, length-1 is the newest)
+    float operator[](uint8_t i) const
+    {
+      return 0.1 * values[wrap(newest + ( capacity - length + 1 ) + i, capacity)];
+    }
+
+    // Returns true if the newest altitude was saturated
+    bool isNewestSaturated() const
+    {
+      return ( values[newest] == saturationMax || values[newest] == saturationMin );
+    }
+
+    // Sets the number of the last altitudes used to calculate the minimum and the maximum (1 to maxWindow)
+    void setExtremaWindow(uint8_t w)
+    {
+      window = ( w < 1 ? 1 : ( w > maxWindow ? maxWindow : w ) );
+      rebuildExtrema();
+    }
+
+    // Returns the minimum of the last 'window' altitudes (m)
+    float getMinimum() const {return 0.1 * values[minDeque.slots[minDeque.front]];};
+
+    // Returns the maximum of the last 'window' altitudes (m)
+    float getMaximum() const {return 0.1 * values[maxDeque.slots[maxDeque.front]];};
+
+    // Returns true if some of the last 'window' altitudes was saturated
+    bool isWindowSaturated() const 
+    {
+      return ( values[maxDeque.slots[maxDeque.front]] == saturationMax || values[minDeque.slots[minDeque.front]] == saturationMin );
+    }
+
+  private:
+
+    static constexpr uint8_t capacity {length > maxWindow ? length : maxWindow}; // Number of altitudes of the buffer
+
+    static_assert(length > 0 && maxWindow > 0 && capacity <= 128, "The altitude history must hold from 1 to 128 altitudes");
+
+    static constexpr int16_t saturationMax {32767}; // Saturated altitudes (dm)
+    static constexpr int16_t saturationMin {-32768};
+
+    // Indexes of the altitudes of a monotonic deque (see the note about the monotonic deques)
+    struct Deque
+    {
+      uint8_t slots[maxWindow]; // Circular buffer of the indexes of the altitudes, from the front to the back
+      uint8_t front {0};        // Position of the front in slots
+      uint8_t size {0};         // Number of indexes
+    };
+
+    // Wraps the index i (less than 2n) around n
+    static uint8_t wrap(uint8_t i, uint8_t n) {return ( i >= n ? i - n : i );};
+
+    // Converts h (m) to decimeters, saturating it (NaN is saturated to the maximum)
+    static int16_t toDecimeters(float h)
+    {
+      float dh = 10.0 * h;
+      if ( ! ( dh < saturationMax ) ) return saturationMax;
+      if ( dh <= saturationMin ) return saturationMin;
+      return (int16_t)( dh < 0.0 ? dh - 0.5 : dh + 0.5 );
+    }
+
+    // Appends the altitude of the index 'slot', which must be the newest one, to the deque and removes the one that left the window.
+    // If 'isMaximum', the deque keeps decreasing altitudes. Otherwise, it keeps increasing altitudes.
+    void pushExtremum(Deque& d, uint8_t slot, bool isMaximum)
+    {
+      int16_t h = values[slot];
+
+      // The front leaves the window before the new altitude is appended, so that the deque never holds more than 'window' indexes.
+      // The age of the front is 1 to capacity time steps (capacity if its altitude was just overwritten).
+      if ( d.size > 0 )
+      {
+        uint8_t s = d.slots[d.front];
+        uint8_t age = ( slot > s ? slot - s : slot + capacity - s );
+        if ( age >= window )
+        {
+          d.front = wrap(d.front + 1, maxWindow);
+          d.size--;
+        }
+      }
+
+      while ( d.size > 0 )
+      {
+        int16_t hb = values[d.slots[wrap(d.front + d.size - 1, maxWindow)]];
+        if ( isMaximum ? hb > h : hb < h ) break;
+        d.size--;
+      }
+
+      d.slots[wrap(d.front + d.size, maxWindow)] = slot;
+      d.size++;
+    }
+
+    void pushExtrema(uint8_t slot)
+    {
+      pushExtremum(maxDeque, slot, true);
+      pushExtremum(minDeque, slot, false);
+    }
+
+    // Rebuilds the deques from the last 'window' altitudes
+    void rebuildExtrema()
+    {
+      maxDeque.front = maxDeque.size = minDeque.front = minDeque.size = 0;
+      for (uint8_t k = window; k > 0; --k)
+      {
+        pushExtrema(wrap(newest + capacity - k + 1, capacity));
+      }
+    }
+
+    int16_t   values[capacity] {}; // Circular buffer of altitudes (dm)
+    uint8_t newest {capacity - 1}; // Index of the newest altitude
+    uint8_t     window {maxWindow}; // Number of the last altitudes used to calculate the minimum and the maximum
+    Deque                 minDeque; // Deque of the minimum (indexes of increasing altitudes)
+    Deque                 maxDeque; // Deque of the maximum (indexes of decreasing altitudes)
+};
+
+#endif // ALTITUDEHISTORY_H
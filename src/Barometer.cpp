@@ -26,25 +26,107 @@
 #include "Barometer.h"
 #include "ParametersStatic.h"
 
+static_assert(sizeof(ParametersStatic::pinBarometerCS)/sizeof(ParametersStatic::pinBarometerCS[0]) >= ParametersStatic::maxNumberOfBarometers, 
+  "A chip select pin is required for each barometer");
+
 bool Barometer::begin()
 {
 
-  Wire.begin();
+  numberOfBarometers = 0;
+
+  if ( ParametersStatic::barometerBus == BarometerBus::spi )
+  {
+
+    for (uint8_t i = 0; i < maxNumberOfBarometers; ++i)
+    {
+
+      BarometerSensor& sensor = sensors[numberOfBarometers];
+
+      sensor.bmp = Adafruit_BMP280(ParametersStatic::pinBarometerCS[i], &SPI);
+
+      sensor.bmp.setSPIClock(ParametersStatic::barometerSPIClock);
 
-  if ( searchBarometerAddress )
+      // Initializing BMP (the I2C address is ignored by the SPI bus)
+      if ( beginSensor(sensor, BMP280_ADDRESS) ) numberOfBarometers++;
+
+    }
+
+  }
+  else
   {
 
-    // Searching for barometer address
-    if ( ! getBarometerAddress(barometerAddress) ) return false;
+    // Addresses available to the BMP280
+    static constexpr uint8_t addresses[] {BMP280_ADDRESS_ALT, BMP280_ADDRESS};
+
+    Wire.begin();
+
+    for (uint8_t i = 0; i < sizeof(addresses) && numberOfBarometers < maxNumberOfBarometers; ++i)
+    {
+
+      // Searching for a barometer at the address
+      Wire.beginTransmission(addresses[i]);
+
+      if ( Wire.endTransmission() != 0 ) continue;
+
+      BarometerSensor& sensor = sensors[numberOfBarometers];
+
+      sensor.bmp = Adafruit_BMP280(&Wire);
+
+      // Initializing BMP
+      if ( beginSensor(sensor, addresses[i]) ) numberOfBarometers++;
+
+    }
+
+    // The clock must be set after the initialization of the sensors, because Wire.begin() restores the standard clock
+    setI2CClock(ParametersStatic::barometerBus);
+
+  }
+
+  if ( numberOfBarometers == 0 ) return false;
+
+  firstSensor = 0;
+  fusedAltitude = 0.0;
+  rateOfClimb = 0.0;
+  rateReferenceAltitude = 0.0;
+  timeOfLastReading = micros();
+  timeOfRateReference = timeOfLastReading;
+  fresh = true;
+  numberOfReadings = 0;
+  numberOfStaleReadings = 0;
+
+  return true;
+}
+
 
+bool Barometer::beginSensor(BarometerSensor& sensor, uint8_t address)
+{
+
+  if ( ! sensor.bmp.begin(address) ) return false;
+
+  // The default sampling of the BMP280 (16x oversampling of pressure and temperature) takes up to 
+  // 75 ms per conversion. High-rate acquisition requires the faster 4x pressure oversampling (up to 14 ms).
+  if ( ParametersStatic::acquisitionOversampling > 1 )
+  {
+    sensor.bmp.setSampling(Adafruit_BMP280::MODE_NORMAL,
+                           Adafruit_BMP280::SAMPLING_X1,
+                           Adafruit_BMP280::SAMPLING_X4,
+                           Adafruit_BMP280::FILTER_OFF,
+                           Adafruit_BMP280::STANDBY_MS_1);
   }
 
-  // Initializing BMP
-  if (!barometer.begin(barometerAddress)) return false;
+  sensor.baseline = sensor.bmp.readAltitude(1013.25);
 
-  baseline = barometer.readAltitude(1013.25);
+  sensor.altitude = 0.0;
+  sensor.variance = minimumVariance;
+  sensor.lastRawTemperature = sensor.bmp.getRawTemperature();
+  sensor.lastRawPressure = sensor.bmp.getRawPressure();
+  sensor.consecutiveStaleReadings = 0;
+  sensor.health = 100;
+  sensor.fresh = true;
+  sensor.withinGate = true;
 
   return true;
+
 }
 
 
@@ -52,48 +134,222 @@ float Barometer::getAltitude()
 {
 
   float altitude = 0.0;
-  
-  altitude = barometer.readAltitude();
 
-  altitude -= baseline;
+  // Predicting the altitude from the last fused altitude and the rate of climb
+  uint32_t currentTime = micros();
+  float predictedAltitude = fusedAltitude + rateOfClimb * ( currentTime - timeOfLastReading ) * 1E-6;
+
+  // Reading the sensors back to back, alternating the first one (see the note about redundant barometers in the header)
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
+  {
+    readSensor(sensors[(firstSensor + i) % numberOfBarometers], predictedAltitude);
+  }
+  firstSensor = ( firstSensor + 1 ) % numberOfBarometers;
+
+  if ( numberOfBarometers == 1 )
+  {
+    // With only one sensor, its reading is always used
+    altitude = sensors[0].altitude;
+    fresh = sensors[0].fresh;
+  }
+  else
+  {
+    altitude = fuseReadings();
+  }
+
+  if ( fresh )
+  {
+    fusedAltitude = altitude;
+    timeOfLastReading = currentTime;
+
+    // Updating the rate of climb. Short intervals would amplify the noise of the readings.
+    float dt = ( currentTime - timeOfRateReference ) * 1E-6;
+
+    if ( dt >= minimumRateInterval )
+    {
+      rateOfClimb += rateSmoothing * ( ( altitude - rateReferenceAltitude ) / dt - rateOfClimb );
+      rateReferenceAltitude = altitude;
+      timeOfRateReference = currentTime;
+    }
+  }
+
+  numberOfReadings++;
+  if ( ! fresh ) numberOfStaleReadings++;
 
   return altitude;
 
 }
 
 
+void Barometer::readSensor(BarometerSensor& sensor, float predictedAltitude)
+{
+
+  float altitude = sensor.bmp.readAltitude() - sensor.baseline;
+
+  // Invalid readings (e.g. communication failure) are not used
+  if ( isnan(altitude) || fabs(altitude) > maxAbsoluteAltitude )
+  {
+    sensor.fresh = false;
+    sensor.withinGate = false;
+    sensor.health = ( sensor.health > invalidPenalty ? sensor.health - invalidPenalty : 0 );
+    return;
+  }
+
+  sensor.altitude = altitude;
+
+  // Checking if the sensor has updated its data registers since the last reading
+  int32_t rawTemperature = sensor.bmp.getRawTemperature();
+  int32_t rawPressure = sensor.bmp.getRawPressure();
+
+  sensor.fresh = ( rawTemperature != sensor.lastRawTemperature || rawPressure != sensor.lastRawPressure );
+
+  sensor.lastRawTemperature = rawTemperature;
+  sensor.lastRawPressure = rawPressure;
+
+  if ( ! sensor.fresh )
+  {
+    // A sensor that stops updating its data registers is stuck
+    if ( sensor.consecutiveStaleReadings < stuckReadingsLimit )
+    {
+      sensor.consecutiveStaleReadings++;
+    }
+    else
+    {
+      sensor.health = 0;
+    }
+    return;
+  }
+
+  sensor.consecutiveStaleReadings = 0;
+
+  // Innovation statistics
+  float innovation2 = ( altitude - predictedAltitude ) * ( altitude - predictedAltitude );
+
+  sensor.withinGate = ( innovation2 <= gateSigma * gateSigma * max(sensor.variance, minimumVariance) );
+
+  sensor.variance += varianceSmoothing * ( innovation2 - sensor.variance );
+
+}
+
+
+float Barometer::fuseReadings()
+{
+
+  // Checking if any active sensor is within its gate. If none is, e.g. during a sudden 
+  // change of acceleration, the gates are not applied.
+  bool applyGate = false;
+
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
+  {
+    const BarometerSensor& sensor = sensors[i];
+
+    if ( sensor.fresh && sensor.health >= minimumHealth && sensor.withinGate ) applyGate = true;
+  }
+
+  // Inverse-variance weighted average of the fresh readings of the active sensors
+  float weightedSum = 0.0;
+  float weightSum = 0.0;
+  int8_t healthiest = -1;
+
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
+  {
+    BarometerSensor& sensor = sensors[i];
+
+    if ( ! sensor.fresh ) continue;
+
+    // Only disagreements with the other sensors reduce the health
+    if ( applyGate && ! sensor.withinGate )
+    {
+      sensor.health = ( sensor.health > outlierPenalty ? sensor.health - outlierPenalty : 0 );
+    }
+    else if ( sensor.health < 100 )
+    {
+      sensor.health++;
+    }
+
+    if ( healthiest < 0 || sensor.health > sensors[healthiest].health ) healthiest = i;
+
+    if ( sensor.health < minimumHealth || ( applyGate && ! sensor.withinGate ) ) continue;
+
+    float weight = 1.0 / max(sensor.variance, minimumVariance);
+
+    weightedSum += weight * sensor.altitude;
+    weightSum += weight;
+  }
+
+  // No fresh reading: the last fused altitude is repeated
+  if ( healthiest < 0 )
+  {
+    fresh = false;
+    return fusedAltitude;
+  }
+
+  fresh = true;
+
+  // No active sensor: the healthiest one is used
+  if ( weightSum == 0.0 )
+  {
+    return sensors[healthiest].altitude;
+  }
+
+  return weightedSum / weightSum;
+
+}
+
+
 void Barometer::setBaseline(float baseline)
 {
    
-   this->baseline = this->baseline + baseline;
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
+  {
+    sensors[i].baseline = sensors[i].baseline + baseline;
+  }
+
+  fusedAltitude = fusedAltitude - baseline;
+  rateReferenceAltitude = rateReferenceAltitude - baseline;
    
 }
 
 
-bool Barometer::getBarometerAddress(byte& address)
+uint32_t Barometer::measureReadTime(BarometerBus bus, uint8_t numberOfReadings)
 {
 
-  byte err;
-  int  counter {0};
+  // I2C and SPI are not interchangeable at runtime
+  if ( ( bus == BarometerBus::spi ) != ( ParametersStatic::barometerBus == BarometerBus::spi ) ) return 0;
+
+  if ( numberOfReadings == 0 || numberOfBarometers == 0 ) return 0;
+
+  setI2CClock(bus);
 
-  for (byte addr = 1; addr < 127; addr++ )
+  uint32_t t0 = micros();
+
+  for (uint8_t i = 0; i < numberOfReadings; ++i)
   {
+    sensors[0].bmp.readAltitude();
+  }
 
-    Wire.beginTransmission(addr);
+  uint32_t elapsedTime = micros() - t0;
 
-    err = Wire.endTransmission();
+  setI2CClock(ParametersStatic::barometerBus);
 
-    if (err == 0)
-    {
-      counter++;
+  return elapsedTime / numberOfReadings;
 
-      address = addr;
-    }
+}
 
-  }
 
-  if ( counter != 1 ) return false;
+void Barometer::setI2CClock(BarometerBus bus)
+{
 
-  return true;
+  switch (bus)
+  {
+    case BarometerBus::i2cStandard:
+      Wire.setClock(i2cStandardClock);
+      break;
+    case BarometerBus::i2cFast:
+      Wire.setClock(i2cFastClock);
+      break;
+    default:
+      break;
+  }
 
-};
+}
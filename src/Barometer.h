@@ -27,7 +27,9 @@
 #define BAROMETER_H
 
 #include "Adafruit_BMP280.h"
+#include "ParametersStatic.h"
 #include <Wire.h>
+#include <SPI.h>
 
 /*
 
@@ -35,31 +37,139 @@
 
 */
 
+/*
+  Note about redundant barometers
+  -------------------------------
+
+  Barometer manages up to ParametersStatic::maxNumberOfBarometers sensors. In the I2C bus, the
+  sensors are searched at the two addresses available to the BMP280 (0x76 and 0x77). In the SPI 
+  bus, each sensor has its own chip select pin (ParametersStatic::pinBarometerCS).
+
+  At every call of getAltitude, the sensors are read back to back. The first sensor to be read 
+  alternates between calls, so that none of them is systematically read later than the others.
+  The altitude is the inverse-variance weighted average of the fresh readings of the active sensors.
+  The variance of each sensor is the running mean of the square of its innovation, i.e., the 
+  difference between its reading and the altitude predicted from the last fused altitude and 
+  the rate of climb.
+
+  Each sensor has a health score (0 to 100). The score is reduced by readings out of the physical
+  range and by innovations out of the gate (gateSigma standard deviations). It is zeroed if the sensor 
+  stops updating its data registers (stuckReadingsLimit consecutive stale readings). Healthy readings 
+  increase the score. Sensors with score below minimumHealth are excluded from the fusion until they
+  recover. A reading out of the gate is excluded from the fusion immediately, if another sensor
+  is within its gate. So, a single stuck sensor can neither delay nor trigger a flight event.
+  With only one sensor, its reading is always used.
+*/
+
+struct BarometerSensor
+{
+  Adafruit_BMP280   bmp;                            // BMP280 sensor manager
+  float             baseline {0};                   // Altitude at launch ramp
+  float             altitude {0};                   // Last altitude read (m)
+  float             variance {0};                   // Running variance of the innovation (m2)
+  int32_t           lastRawTemperature {0};         // Raw ADC word of the temperature of the last reading
+  int32_t           lastRawPressure {0};            // Raw ADC word of the pressure of the last reading
+  uint8_t           consecutiveStaleReadings {0};   // Number of consecutive stale readings
+  uint8_t           health {100};                   // Health score (0 to 100)
+  bool              fresh {true};                   // True if the last reading is a new conversion
+  bool              withinGate {true};              // True if the last innovation is within the gate
+};
+
 class Barometer
 {
 
   public:
-    // Initializes barometer. Returns true if successful initialization.
+    // Initializes barometer. Returns true if, at least, one sensor was initialized.
     bool begin();
 
-    // Get current altitude
+    // Get current altitude (fusion of the readings of the active sensors)
     float getAltitude();
+
+    /*
+      Returns true if the last reading is a new conversion of the sensor. In normal mode,
+      the BMP280 updates its data registers on its own schedule, so reading it faster than
+      the conversion time returns the previous conversion again (a stale reading).
+      Stale readings are identified by comparing the raw ADC words with the previous ones.
+      With redundant sensors, the reading is fresh if any active sensor is fresh.
+    */
+    bool isFresh(){return fresh;};
+
+    // Returns the number of readings since the initialization
+    uint32_t getNumberOfReadings(){return numberOfReadings;};
+
+    // Returns the number of stale readings since the initialization
+    uint32_t getNumberOfStaleReadings(){return numberOfStaleReadings;};
+
+    // Returns the number of sensors found by begin()
+    uint8_t getNumberOfBarometers(){return numberOfBarometers;};
+
+    // Returns the health score (0 to 100) of sensor i
+    uint8_t getHealth(uint8_t i){return sensors[i].health;};
+
+    // Returns the variance of the innovation (m2) of sensor i
+    float getInnovationVariance(uint8_t i){return sensors[i].variance;};
     
     // Set baseline
     void setBaseline(float baseline);
 
+    // Returns the baseline (m above the standard sea level pressure) of the first sensor
+    float getBaseline(){return sensors[0].baseline;};
+
+    /*
+      Microbenchmark: returns the mean time (microseconds) to read the barometer 
+      through the given bus. Since I2C and SPI require different wirings, only
+      the I2C clock can be changed at runtime. If the bus is not available,
+      returns 0. The bus configured in ParametersStatic is restored at the end.
+    */
+    uint32_t measureReadTime(BarometerBus bus, uint8_t numberOfReadings);
+
   private:
 
-    // Search for barometer address
-    bool getBarometerAddress(byte& address);
+    // Initializes a sensor at the given I2C address (ignored by the SPI bus)
+    bool beginSensor(BarometerSensor& sensor, uint8_t address);
+
+    // Reads a sensor and updates its freshness, its innovation statistics and its health
+    void readSensor(BarometerSensor& sensor, float predictedAltitude);
+
+    // Fuses the fresh readings of the active sensors and updates their health
+    float fuseReadings();
+
+    // Sets the clock of the I2C bus (standard or fast mode)
+    void setI2CClock(BarometerBus bus);
 
 
   private:
 
-    Adafruit_BMP280   barometer;                       // BMP280 sensor manager
-    float             baseline {0};                    // Altitude at launch ramp
-    byte              barometerAddress;                // BMP I2C address
-    bool              searchBarometerAddress {true};   // If BMP address is known, fill it in the previous line and mark this variable as false
+    static constexpr uint8_t maxNumberOfBarometers {ParametersStatic::maxNumberOfBarometers};
+
+    BarometerSensor   sensors[maxNumberOfBarometers];  // Sensors
+    uint8_t           numberOfBarometers {0};          // Number of sensors found
+    uint8_t           firstSensor {0};                 // First sensor to be read at the next call of getAltitude
+
+    float             fusedAltitude {0};               // Last fused altitude (m)
+    float             rateOfClimb {0};                 // Smoothed rate of climb (m/s)
+    uint32_t          timeOfLastReading {0};           // Time of the last fresh reading (microseconds)
+    float             rateReferenceAltitude {0};       // Fused altitude at the last update of the rate of climb (m)
+    uint32_t          timeOfRateReference {0};         // Time of the last update of the rate of climb (microseconds)
+
+    bool              fresh {true};                    // True if the last reading is a new conversion
+    uint32_t          numberOfReadings {0};            // Number of readings since the initialization
+    uint32_t          numberOfStaleReadings {0};       // Number of stale readings since the initialization
+
+    static constexpr uint32_t i2cStandardClock {100000};  // I2C clock in standard mode (Hz)
+    static constexpr uint32_t     i2cFastClock {400000};  // I2C clock in fast mode (Hz)
+
+    // Parameters of the health score (see the note about redundant barometers)
+    static constexpr float         minimumVariance     {1.0}; // Lower bound of the variance of the innovation (m2)
+    static constexpr float       varianceSmoothing  {0.0625}; // Weight of the new innovation in the running variance
+    static constexpr float           rateSmoothing     {0.5}; // Weight of the new rate of climb in the smoothed one
+    static constexpr float     minimumRateInterval    {0.05}; // Minimum interval to update the rate of climb (s)
+    static constexpr float               gateSigma     {5.0}; // Gate of the innovation (standard deviations)
+    static constexpr float     maxAbsoluteAltitude {20000.0}; // Readings out of this range (m) are invalid
+    static constexpr uint8_t    stuckReadingsLimit      {10}; // Consecutive stale readings to consider a sensor stuck
+    static constexpr uint8_t         minimumHealth      {50}; // Sensors below this health score are excluded
+    static constexpr uint8_t        outlierPenalty      {10}; // Health penalty of an innovation out of the gate
+    static constexpr uint8_t        invalidPenalty      {25}; // Health penalty of an invalid reading
 };
 
 #endif // BAROMETER_H
@@ -0,0 +1,63 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <inttypes.h>
+
+/*
+  CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, no reflection, no final xor).
+  The check value of the string "123456789" is 0x29B1.
+
+  Usage:
+    uint16_t crc = crc16Initial;
+    for (each byte b) crc = crc16Update(crc, b);
+*/
+
+static constexpr uint16_t crc16Initial {0xFFFF}; // Initial value of the CRC
+
+// Updates the CRC with the next byte
+inline uint16_t crc16Update(uint16_t crc, uint8_t byte)
+{
+  crc ^= (uint16_t) byte << 8;
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = ( crc & 0x8000 ? ( crc << 1 ) ^ 0x1021 : crc << 1 );
+  }
+  return crc;
+}
+
+// Returns the CRC of n bytes
+inline uint16_t crc16(const uint8_t* data, uint16_t n, uint16_t crc = crc16Initial)
+{
+  for (uint16_t i = 0; i < n; ++i)
+  {
+    crc = crc16Update(crc, data[i]);
+  }
+  return crc;
+}
+
+#endif // CRC16_H
@@ -62,29 +62,9 @@ void KalmanAlphaFilterFlightStatistics::process(const float& sMeasured)
   /****************************
       Prediction step
   ****************************/
-  s += v*T + a*T2;
-  v +=       a*T;
-  //a = a;
   float a0 = a;
 
-  if ( v > 170 )
-  {
-    Vmod = VmodTra;
-  }
-  else
-  {
-    Vmod = VmodSub;
-  }
-  
-  float c1 = P22*T2;
-  float c2 = P22*T;
-
-  Ph00 = (c1+2.0*P12*T+2.0*P02)*T2+(P11*T+2.0*P01)*T+P00;
-  Ph11 = (c2+2.0*P12)*T+P11;
-  Ph22 = P22+Vmod*T*T;
-  Ph01 = (c2+P12)*T2+(P12*T+P02+P11)*T+P01;
-  Ph02 = c1+P12*T+P02;
-  Ph12 = c2+P12;
+  predictState();
   
   
   /****************************
@@ -116,4 +96,48 @@ void KalmanAlphaFilterFlightStatistics::process(const float& sMeasured)
 
   // Alpha filter
   vs += (v-vs)/(1.0+fabs(a-a0)*da_ref_inv);
-};
\ No newline at end of file
+};
+
+
+void KalmanAlphaFilterFlightStatistics::predict()
+{
+  predictState();
+
+  // Without a measurement, the covariance is the predicted one
+  P00 = Ph00;
+  P01 = Ph01;
+  P02 = Ph02;
+  P11 = Ph11;
+  P12 = Ph12;
+  P22 = Ph22;
+
+  // The acceleration is constant in the prediction step, so the smoothed velocity is just propagated
+  vs += a*T;
+}
+
+
+void KalmanAlphaFilterFlightStatistics::predictState()
+{
+  s += v*T + a*T2;
+  v +=       a*T;
+  //a = a;
+
+  if ( v > 170 )
+  {
+    Vmod = VmodTra;
+  }
+  else
+  {
+    Vmod = VmodSub;
+  }
+  
+  float c1 = P22*T2;
+  float c2 = P22*T;
+
+  Ph00 = (c1+2.0*P12*T+2.0*P02)*T2+(P11*T+2.0*P01)*T+P00;
+  Ph11 = (c2+2.0*P12)*T+P11;
+  Ph22 = P22+Vmod*T*T;
+  Ph01 = (c2+P12)*T2+(P12*T+P02+P11)*T+P01;
+  Ph02 = c1+P12*T+P02;
+  Ph12 = c2+P12;
+}
\ No newline at end of file
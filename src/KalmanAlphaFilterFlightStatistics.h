@@ -54,6 +54,12 @@ public:
   */ 
   void process(const float& sMeasured);
 
+  /*
+    Propagates the state (position, velocity and acceleration) without
+    a new measurement, e.g., when the sensor returned a stale reading
+  */ 
+  void predict();
+
 public:
   // Variables of public access
   float s; // Position
@@ -64,6 +70,9 @@ public:
 
 private:
 
+  // Prediction step of the state and of the covariance matrix
+  void predictState();
+
   // Kalman filter parameters
   float         T; // Time step
   float        T2; // T*T/2
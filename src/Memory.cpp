@@ -26,9 +26,15 @@
 #include "Arduino.h"
 #include "Memory.h"
 #include "ParametersStatic.h"
+#include "Profiler.h"
+#include "Crc16.h"
 
 bool Memory::begin()
 {
+  // Discarding the altitudes queued before the initialization
+  queueHead = 0;
+  queueTail = 0;
+
   // Number of available slots to save altitudes during flight
   numberOfSlots = (uint16_t)(((float)EEPROM.length()-addrAltitudesBegin)/2.0)-1;
 
@@ -77,8 +83,23 @@ float Memory::readAltitude(const uint16_t& i)
   return fAltitude;
 }
 
+int32_t Memory::readAltitudeDecimeters(const uint16_t& i)
+{
+  // If the position is out of range, returns 0
+  if ( i >= numberOfSlots ) return 0;
+
+  uint16_t iAltitude;
+
+  EEPROM.get(2 * i + addrAltitudesBegin, iAltitude);
+
+  // Removing the 500 m (5000 dm) added when the altitude was saved
+  return (int32_t) iAltitude - 5000;
+}
+
 bool Memory::writeAltitude(const uint16_t& i, float fAltitude)
 {
+  PROFILE_STAGE(ProfilerStage::writeAltitude);
+
   // If the position is out of range, returns 0
   if ( i >= numberOfSlots ) return false;
 
@@ -145,6 +166,100 @@ bool Memory::appendAltitude(float altitude)
   }
 }
 
+void Memory::queueAltitude(const uint16_t& i, float altitude)
+{
+  if ( (uint8_t)(queueHead - queueTail) == queueCapacity )
+  {
+    // Preserving the order of the writes
+    writeQueuedAltitude();
+  }
+  QueuedAltitude& entry = queue[queueHead & (queueCapacity-1)];
+  entry.slot = i;
+  entry.altitude = altitude;
+  queueHead++;
+}
+
+bool Memory::writeQueuedAltitude()
+{
+  if ( queueHead == queueTail ) return false;
+
+  const QueuedAltitude& entry = queue[queueTail & (queueCapacity-1)];
+  if ( entry.slot == appendSlot )
+  {
+    appendAltitude(entry.altitude);
+  }
+  else if ( entry.slot == groundLevelSlot )
+  {
+    writeGroundLevel(entry.altitude);
+  }
+  else
+  {
+    writeAltitude(entry.slot, entry.altitude);
+  }
+  queueTail++;
+  return true;
+}
+
+void Memory::queueDeploymentTiming(const char& c, const DeploymentTiming& timing)
+{
+  uint16_t address = ( c == 'D' ? addrDrogueTiming : addrParachuteTiming );
+  if ( timingBytesQueued > 0 && address != queuedTimingAddress )
+  {
+    // Preserving the timing of the other event
+    while ( writeQueuedTiming() );
+  }
+  queuedTiming = timing;
+  queuedTimingAddress = address;
+  timingBytesQueued = sizeof(DeploymentTiming);
+}
+
+bool Memory::writeQueuedTiming()
+{
+  if ( timingBytesQueued == 0 ) return false;
+
+  // The unchanged bytes are skipped, since reading is fast and only writing takes about 3.3 ms per byte
+  const uint8_t* data = (const uint8_t*) &queuedTiming;
+  uint8_t bytesWritten = 0;
+  while ( timingBytesQueued > 0 && bytesWritten < timingBytesPerWrite )
+  {
+    uint16_t i = sizeof(DeploymentTiming) - timingBytesQueued;
+    if ( EEPROM.read(queuedTimingAddress + i) != data[i] )
+    {
+      EEPROM.write(queuedTimingAddress + i, data[i]);
+      bytesWritten++;
+    }
+    timingBytesQueued--;
+  }
+  return true;
+}
+
+uint8_t Memory::readLog(uint16_t offset, uint8_t* data, uint8_t n)
+{
+  uint16_t size = getLogSize();
+
+  if ( offset >= size ) return 0;
+
+  if ( n > size - offset ) n = (uint8_t)( size - offset );
+
+  for (uint8_t i = 0; i < n; ++i)
+  {
+    data[i] = EEPROM.read(addrAltitudesBegin + offset + i);
+  }
+  return n;
+}
+
+uint16_t Memory::readLogCrc()
+{
+  uint16_t crc = crc16Initial;
+  uint16_t size = getLogSize();
+
+  for (uint16_t i = 0; i < size; ++i)
+  {
+    crc = crc16Update(crc, EEPROM.read(addrAltitudesBegin + i));
+  }
+  return crc;
+}
+
 float Memory::readApogee()
 {
   float apogee = 0.0;
@@ -227,6 +342,10 @@ void Memory::erase()
   EEPROM.put(addrDrogueEvent, value);
   EEPROM.put(addrParachuteEvent, value);
   EEPROM.put(addrLandedEvent, value);
+  EEPROM.put(addrGroundLevel, 0.0f);
+  DeploymentTiming timing;
+  EEPROM.put(addrDrogueTiming, timing);
+  EEPROM.put(addrParachuteTiming, timing);
 
   value = 0xFF; // Maximum value of uint16_t (hexadecimal) 
   /*
@@ -237,6 +356,9 @@ void Memory::erase()
   */
   EEPROM.put(addrAltitudesBegin, value);
   numberOfSlotsWritten = 0;
+  queueHead = 0;
+  queueTail = 0;
+  timingBytesQueued = 0;
 };
 
 
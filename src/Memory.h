@@ -46,6 +46,18 @@
     h" = h' % 65000
 */
 
+/*
+  Timing of a deployment (microseconds). The latencies are measured from the instant of the first
+  reading that satisfied the deployment condition.
+*/
+struct DeploymentTiming
+{
+  uint32_t conditionToTransition {0}; // Latency up to the change of the recovery system's state
+  uint32_t    conditionToPinHigh {0}; // Latency up to the first rising edge of the actuator pin
+  uint32_t     minimumPulseWidth {0}; // Minimum width of the pulses of the actuator pin
+  uint32_t     maximumPulseWidth {0}; // Maximum width of the pulses of the actuator pin
+};
+
 class Memory
 {
 
@@ -66,12 +78,47 @@ class Memory
     // Reads the altitude from EEPROM memory at slot position i (0 <= i <= getNumberOfSlots())
     float readAltitude(const uint16_t& i);
 
+    // Reads the altitude (decimeters) from EEPROM memory at slot position i, without float operations
+    int32_t readAltitudeDecimeters(const uint16_t& i);
+
     // Writes the altitude at EEPROM memory at slot position i (0 <= i <= getNumberOfSlots())
     bool writeAltitude(const uint16_t& i, float altitude);
 
     // Appends the altitude to EEPROM memory
     bool appendAltitude(float altitude);
 
+    /*
+      Queues the altitude to be written at slot position i by writeQueuedAltitude().
+      Writing to EEPROM takes about 3.3 ms per byte, so the queue allows the writes
+      to be performed when there is time for them. If the queue is full, the oldest 
+      altitude of the queue is written immediately.
+    */
+    void queueAltitude(const uint16_t& i, float altitude);
+
+    // Queues the altitude to be appended to EEPROM memory (see queueAltitude)
+    void queueAppendAltitude(float altitude){queueAltitude(appendSlot, altitude);};
+
+    // Queues the ground level at liftoff to be written with the altitudes (see queueAltitude and writeGroundLevel)
+    void queueGroundLevel(float groundLevel){queueAltitude(groundLevelSlot, groundLevel);};
+
+    // Writes the oldest altitude (or ground level) of the queue. Returns false if the queue is empty.
+    bool writeQueuedAltitude();
+
+    // Writes all the altitudes and the timing of the queue
+    void flushQueue(){while ( writeQueuedAltitude() ); while ( writeQueuedTiming() );};
+
+    // Returns the number of bytes of the log of altitudes (2 bytes per slot written, see the note at the top)
+    uint16_t getLogSize(){return 2*numberOfSlotsWritten;};
+
+    /*
+      Copies up to n bytes of the log of altitudes, starting at the byte offset, to data.
+      Returns the number of bytes copied (0 if offset is beyond the end of the log).
+    */
+    uint8_t readLog(uint16_t offset, uint8_t* data, uint8_t n);
+
+    // Returns the CRC-16 of the whole log of altitudes (see Crc16.h)
+    uint16_t readLogCrc();
+
     // Get apogee from EEPROM memory
     float readApogee();
 
@@ -88,6 +135,39 @@ class Memory
     // Reads deltaTMultiplier of the event c from the memory (see writeEvent for more details)
     uint16_t readEvent(const char& c);
 
+    /*
+      Queues the timing of the deployment of the event c ('D': drogue, 'P': parachute) to be written
+      by writeQueuedTiming(), a few bytes at a time, like the altitudes (see queueAltitude). If the 
+      timing of the other event is still queued, it is written immediately.
+    */
+    void queueDeploymentTiming(const char& c, const DeploymentTiming& timing);
+
+    // Writes the next bytes of the queued timing that changed. Returns false if no timing is queued.
+    bool writeQueuedTiming();
+
+    // Reads the timing of the deployment of the event c ('D': drogue, 'P': parachute)
+    DeploymentTiming readDeploymentTiming(const char& c)
+    {
+      DeploymentTiming timing;
+
+      EEPROM.get(( c == 'D' ? addrDrogueTiming : addrParachuteTiming ), timing);
+
+      return timing;
+    }
+
+    // Writes the ground level at liftoff (m above the standard sea level pressure)
+    void writeGroundLevel(float groundLevel){EEPROM.put(addrGroundLevel, groundLevel);};
+
+    // Reads the ground level at liftoff (m above the standard sea level pressure)
+    float readGroundLevel()
+    {
+      float groundLevel = 0.0;
+
+      EEPROM.get(addrGroundLevel, groundLevel);
+
+      return groundLevel;
+    }
+
     // Returns the log of errors of the last flight
     uint16_t readErrorLog()
     {
@@ -134,13 +214,35 @@ class Memory
     static constexpr uint16_t addrDrogueEvent              {addrliftoffEvent+2};
     static constexpr uint16_t addrParachuteEvent           {addrDrogueEvent+2};
     static constexpr uint16_t addrLandedEvent              {addrParachuteEvent+2};
-    static constexpr uint16_t addrAltitudesBegin           {addrLandedEvent+2};
+    static constexpr uint16_t addrGroundLevel              {addrLandedEvent+2};
+    static constexpr uint16_t addrDrogueTiming             {addrGroundLevel+4};
+    static constexpr uint16_t addrParachuteTiming          {addrDrogueTiming+sizeof(DeploymentTiming)};
+    static constexpr uint16_t addrAltitudesBegin           {addrParachuteTiming+sizeof(DeploymentTiming)};
 
     // Number of slots written in the memory (refers to the last slot written)
     uint16_t numberOfSlotsWritten {0};
 
     // Number of slots available in the memory
     uint16_t numberOfSlots {0};
+
+    // Queue of altitudes to be written (ring buffer)
+    struct QueuedAltitude
+    {
+      uint16_t slot;
+      float altitude;
+    };
+    static constexpr uint16_t appendSlot {0xFFFF}; // Slot of the altitudes to be appended
+    static constexpr uint16_t groundLevelSlot {0xFFFE}; // Slot of the ground level (see queueGroundLevel)
+    static constexpr uint8_t queueCapacity {8};    // Capacity of the queue (power of 2)
+    QueuedAltitude queue[queueCapacity];
+    uint8_t queueHead {0}; // Number of altitudes queued
+    uint8_t queueTail {0}; // Number of altitudes written
+
+    // Queued timing of a deployment (see queueDeploymentTiming)
+    static constexpr uint8_t timingBytesPerWrite {2}; // Maximum number of bytes written per call of writeQueuedTiming (as an altitude)
+    DeploymentTiming  queuedTiming; // Timing to be written
+    uint16_t queuedTimingAddress {0}; // Position of the memory of the timing
+    uint8_t    timingBytesQueued {0}; // Number of bytes of the timing not written yet (the last ones)
 };
 
 #endif // MEMORY_H
@@ -26,219 +26,182 @@
 #include "MessageParser.h"
 
 #include "string.h"
-#include "stdlib.h"
-#include "stdio.h"
 
 
-/*
-    Finds the index of the first occurence 
-    of pattern char in str.
-    If the pattern is absent, returns -1.
-*/
-int findFirst(const char *str, char pattern)
-{
-    for (size_t i = 0; i < strlen(str); ++i)
-    {
-        if (str[i] == pattern)
-            return i;
-    }
-    return -1;
-}
-
-/*
-    Finds the index of the last occurence 
-    of pattern char in str.
-    If the pattern is absent, returns -1.
-*/
-int findLast(const char *str, char pattern)
+void MessageParser::begin(char bs, char fs, char es)
 {
-    for (size_t i = strlen(str); i > 0; --i)
-    {
-        if (str[i-1] == pattern)
-            return i-1;
-    }
-    return -1;
+    this->BS = bs;
+    this->ES = es;
+    this->FS = fs;
+    head = 0;
+    tail = 0;
+    state = State::searching;
+    numberOfEntries = 0;
 }
 
-/*
-    Shift a string left
-*/
-void shiftLeft(char *str, int shift)
+void MessageParser::append(char ch)
 {
-    int sz = strlen(str);
-
-    if (shift < 0)
-        return;
-
-    if (shift >= sz)
+    // Ignores new line, return carriage and null characters
+    if (!(ch == '\n' || ch == '\r' || ch == '\0'))
     {
-        str[0] = '\0';
-        return;
-    }
+        // If the stream is full, the oldest character is discarded
+        if ( (uint8_t)(head - tail) == MSGPARSERBUFFERSIZE )
+            tail++;
 
-    for (int i = 0; i < sz - shift; ++i)
-    {
-        str[i] = str[i + shift];
+        // Copying the input data
+        stream[head & (MSGPARSERBUFFERSIZE-1)] = ch;
+        head++;
     }
-    str[sz - shift] = '\0';
 }
 
-void searchMessage(char *str, char *msg, char bExp, char eExp)
+bool MessageParser::hasMessage()
 {
-    bool searchCompleted = false;
-
-    int idxB, idxE;
+    // The entries of the last message are no longer valid
+    numberOfEntries = 0;
 
-    while (!searchCompleted)
+    // Consuming the input stream (see the note about the parsing in the header)
+    while ( tail != head )
     {
-        // Getting the first occurence of eExp
-        idxE = findFirst(str, eExp);
+        char ch = stream[tail & (MSGPARSERBUFFERSIZE-1)];
+        tail++;
 
-        // Cleaning the message
-        msg[0] = '\0';
+        // The beginning of a message discards any incomplete message
+        if ( ch == BS )
+        {
+            state = State::reading;
+            length = 0;
+            idxvec[0] = 0;
+            entries[0] = {0, -1, false, EntryStatus::empty};
+            numberOfFields = 1;
+            continue;
+        }
 
-        // If end pattern was found
-        if (idxE >= 0)
+        // Out of a message, the characters are discarded
+        if ( state != State::reading ) continue;
+
+        if ( ch == ES )
         {
-            // Copying the first part of the pattern to msg
-            strncpy(msg, str, idxE);
+            state = State::searching;
 
-            // Setting the end of message
-            msg[idxE] = '\0';
+            // Empty messages are ignored
+            if ( length == 0 ) continue;
 
-            // Shifting the str (removing the copied part)
-            shiftLeft(str, idxE + 1);
+            msg[length] = '\0';
+            numberOfEntries = numberOfFields;
+            return true;
+        }
 
-            // Looking for the last occurrence of the start pattern in msg
-            idxB = findLast(msg, bExp);
+        // Too long messages are discarded (one character is reserved for the null character)
+        if ( length == MSGPARSERMAXSIZE-1 )
+        {
+            state = State::searching;
+            continue;
+        }
 
-            // If start pattern was found
-            if (idxB >= 0)
-            {
-                // Formatting the message
-                shiftLeft(msg, idxB + 1);
-                searchCompleted = true;
-            }
-            else
+        if ( ch == FS )
+        {
+            // Messages with too many fields are discarded
+            if ( numberOfFields == MSGPARSERMAXFIELDS )
             {
-                // Message undefined
-                msg[0] = '\0';
-                searchCompleted = false;
+                state = State::searching;
+                continue;
             }
+            msg[length++] = '\0';
+            idxvec[numberOfFields] = length;
+            entries[numberOfFields++] = {0, -1, false, EntryStatus::empty};
         }
-        // If end pattern was NOT found
         else
         {
-            searchCompleted = true;
-
-            // Looking for the last occurrence of the start pattern in str
-            idxB = findLast(str, bExp);
-
-            // If start pattern was found
-            if (idxB >= 0)
-            {
-                // Removing unnecessary text
-                shiftLeft(msg, idxB);
-            }
+            decode(entries[numberOfFields-1], ch, length == idxvec[numberOfFields-1]);
+            msg[length++] = ch;
         }
     }
+    return false;
 }
 
-void MessageParser::begin(char bs, char fs, char es)
+void MessageParser::decode(Entry& entry, char ch, bool isFirst)
 {
-    this->BS = bs;
-    this->ES = es;
-    this->FS = fs;
-}
+    // After an error, the remainder characters are not decoded
+    if ( entry.status == EntryStatus::invalidFormat || entry.status == EntryStatus::overflow ) return;
 
-void MessageParser::append(char ch)
-{
-    // Ignores new line, return carriage and null characters
-    if (!(ch == '\n' || ch == '\r' || ch == '\0'))
+    if ( ch >= '0' && ch <= '9' )
     {
-        // If the str is full, shift it left
-        size_t sz = strlen(str);
-        if (sz == MSGPARSERMAXSIZE)
+        // The digits beyond the maximum number of decimals are truncated
+        if ( entry.decimals >= MSGPARSERMAXDECIMALS ) return;
+
+        uint8_t digit = ch - '0';
+        if ( entry.magnitude > ( 0x7FFFFFFFUL - digit ) / 10 )
         {
-            for (size_t i = 0; i < MSGPARSERMAXSIZE - 1; ++i)
-                str[i] = str[i + 1];
-            sz--;
+            entry.status = EntryStatus::overflow;
+            return;
         }
-
-        // Copying the input data
-        str[sz] = ch;
-        str[sz + 1] = '\0';
+        entry.magnitude = 10 * entry.magnitude + digit;
+        if ( entry.decimals >= 0 ) entry.decimals++;
+        entry.status = EntryStatus::valid;
+    }
+    else if ( ( ch == '-' || ch == '+' ) && isFirst )
+    {
+        entry.negative = ( ch == '-' );
+    }
+    else if ( ch == '.' && entry.decimals < 0 )
+    {
+        entry.decimals = 0;
+    }
+    else
+    {
+        entry.status = EntryStatus::invalidFormat;
     }
 }
 
-bool MessageParser::hasMessage()
-{
-    // Searching for a message between BS and ES in str.
-    // If a message is found, it is moved from str to msg
-    // and the function returns true.
-
-    searchMessage(str, msg, BS, ES);
-    parseMessage();
-
-    return (strlen(msg) > 0 ? true : false);
-}
-
-void MessageParser::getEntryStr(const int& entryNumber, char*  entry)
+const char* MessageParser::getEntryStr(const int& entryNumber)
 {
-    // Initializing the output
-    entry[0] = '\0';
-
     // Is the entryNumber valid?
-    if ( entryNumber < numberOfEntries )
+    if ( entryNumber >= 0 && entryNumber < numberOfEntries )
     {
-        // Copy the entry
-        int16_t idxB = idxvec[entryNumber];
-        int16_t idxE = idxvec[entryNumber+1];
-        if ( idxE > idxB ) 
-        {
-            strncpy(entry,&msg[idxB],idxE-idxB);
-            entry[idxE-idxB-1]='\0';
-        }
+        // The entry is null terminated within the message
+        return &msg[idxvec[entryNumber]];
     }
+    return "";
 }
 
-int MessageParser::getEntryInt(const int& entryNumber)
+MessageParser::EntryStatus MessageParser::getEntryStatus(const int& entryNumber)
 {
-    char buffer[35];
-    getEntryStr(entryNumber,buffer);
-    return atoi(buffer);
+    if ( entryNumber >= 0 && entryNumber < numberOfEntries )
+    {
+        return entries[entryNumber].status;
+    }
+    return EntryStatus::missing;
 }
 
-float MessageParser::getEntryFloat(const int& entryNumber)
+bool MessageParser::getEntryInt(const int& entryNumber, int32_t& value)
 {
-    char buffer[35];
-    getEntryStr(entryNumber,buffer);
-    return atof(buffer);
+    // Integers have no decimal point
+    if ( getEntryStatus(entryNumber) != EntryStatus::valid || entries[entryNumber].decimals >= 0 ) return false;
+
+    const Entry& entry = entries[entryNumber];
+    value = ( entry.negative ? -(int32_t) entry.magnitude : (int32_t) entry.magnitude );
+    return true;
 }
 
-void MessageParser::parseMessage()
+bool MessageParser::getEntryFixed(const int& entryNumber, uint8_t decimals, int32_t& value)
 {
-    size_t sz = strlen(msg);
+    if ( getEntryStatus(entryNumber) != EntryStatus::valid ) return false;
+
+    const Entry& entry = entries[entryNumber];
+    uint32_t magnitude = entry.magnitude;
+    uint8_t  digits = ( entry.decimals < 0 ? 0 : entry.decimals );
 
-    // If the message is empty, the number of entries is zero.
-    // Just return...
-    if ( sz < 1 )
+    // Scaling the magnitude to the required number of decimals
+    for (; digits < decimals; ++digits)
     {
-        numberOfEntries = 0;
-        return;
+        if ( magnitude > 0x7FFFFFFFUL / 10 ) return false;
+        magnitude *= 10;
     }
-
-    // If the message is not empty, there exist,
-    // at least, one entry.
-    numberOfEntries = 1;
-    idxvec[0]=0;
-    for (size_t i=0; i<sz; ++i)
+    for (; digits > decimals; --digits)
     {
-        if (msg[i]==FS)
-        {
-            idxvec[numberOfEntries]=i+1;
-            numberOfEntries++;
-        }
+        magnitude /= 10;
     }
-    idxvec[numberOfEntries]=sz+1;
+
+    value = ( entry.negative ? -(int32_t) magnitude : (int32_t) magnitude );
+    return true;
 }
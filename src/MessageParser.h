@@ -28,8 +28,17 @@
 
 #include "inttypes.h"
 
-#define MSGPARSERMAXSIZE  32 // Maximum number of characters of the message and of the input stream
-#define MSGPARSERMAXFIELDS 2 // Maximum number of entries per message
+// The sizes may be changed through build flags (e.g. -D MSGPARSERMAXFIELDS=12)
+#ifndef MSGPARSERMAXSIZE
+#define MSGPARSERMAXSIZE    64 // Maximum number of characters of the message
+#endif
+#ifndef MSGPARSERBUFFERSIZE
+#define MSGPARSERBUFFERSIZE 64 // Number of characters of the input stream (must be a power of 2, up to 128)
+#endif
+#ifndef MSGPARSERMAXFIELDS
+#define MSGPARSERMAXFIELDS  10 // Maximum number of entries per message
+#endif
+#define MSGPARSERMAXDECIMALS 6 // Maximum number of digits after the decimal point decoded (the remainder digits are truncated)
 
 /*
     MessageParser searches for messages in the input stream.
@@ -45,12 +54,52 @@
         - Append data to the input stream (using append method)
         - Check for new message (using the hasMessage method)
         - If a message was found, i.e., hasMessage returned true, one can
-          retrieve the data through the getEntryXXX methods.
+          retrieve the data through the getEntryXXX methods. The entries are
+          valid until the next call to hasMessage.
+*/
+
+/*
+    Note about the parsing
+    ----------------------
+
+    The input stream is a ring buffer, so appending a character is O(1). If the buffer is 
+    full, the oldest character is discarded. 
+    
+    hasMessage consumes the characters of the buffer through a state machine, until a 
+    message is completed or the buffer is empty. Each character is visited once:
+    - a 'BS' always starts a new message, so the parser resyncs after any garbage;
+    - out of a message, any other character is discarded;
+    - within a message, an 'FS' closes the current entry (it is replaced by a null 
+      character in the message, so that each entry is a string) and an 'ES' closes the message.
+    Messages that exceed MSGPARSERMAXSIZE characters or MSGPARSERMAXFIELDS entries are discarded.
+    Any message that remains incomplete is kept for the next call to hasMessage.
+*/
+
+/*
+    Note about the decoding of the entries
+    --------------------------------------
+
+    Each entry is decoded as a number while its characters are read, so that no entry is 
+    copied or parsed again by atoi/atof. The number must follow the pattern [+|-]digits[.digits].
+    Its digits are accumulated as an integer (the magnitude), together with the sign and the 
+    number of digits after the decimal point. Then, getEntryInt and getEntryFixed only scale 
+    the magnitude. The range of the values is -2147483647 to 2147483647. The status of the
+    decoding tells if the entry is empty, has an invalid character or overflows.
 */
 
 class MessageParser
 {
 public:
+    // Status of the decoding of an entry as a number (see the note about the decoding of the entries)
+    enum class EntryStatus : uint8_t
+    {
+        valid,         // The entry is a number
+        missing,       // The message has no such entry
+        empty,         // The entry has no digit
+        invalidFormat, // The entry has a character that is not allowed
+        overflow       // The entry is out of the range of int32_t
+    };
+
     // Initializer
     void begin(char BS='<', char FS=',', char ES='>');
     
@@ -60,27 +109,62 @@ public:
     // Checks for message. If a message was found, parses it, and returns true.
     bool hasMessage();
 
-    // Returns the entre at entryNumber as a string
-    void getEntryStr(const int& entryNumber, char*  entry);
+    // Returns the number of entries of the last message found
+    uint8_t getNumberOfEntries() const {return numberOfEntries;};
+
+    // Returns the entry at entryNumber as a string (the string belongs to the parser)
+    const char* getEntryStr(const int& entryNumber);
 
-    // Returns the entre at entryNumber as an integer
-    int  getEntryInt(const int& entryNumber);
+    // Returns the status of the decoding of the entry at entryNumber as a number
+    EntryStatus getEntryStatus(const int& entryNumber);
 
-    // Returns the entre at entryNumber as a float
-    float getEntryFloat(const int& entryNumber);
+    // Gets the entry at entryNumber as an integer. Returns false if the entry is not an integer or is out of range.
+    bool getEntryInt(const int& entryNumber, int32_t& value);
+
+    // Gets the entry at entryNumber as a fixed-point number, i.e., value = entry*10^decimals (truncated). 
+    // Returns false if the entry is not a number or is out of range.
+    bool getEntryFixed(const int& entryNumber, uint8_t decimals, int32_t& value);
 
     // Internal variables
     char                      BS {'<'}; // Begin separator
     char                      FS {','}; // Field separator
     char                      ES {'>'}; // End separator
-    char         str[MSGPARSERMAXSIZE]; // The incoming string
-    char         msg[MSGPARSERMAXSIZE]; // The message
-    uint8_t idxvec[MSGPARSERMAXFIELDS]; // Indexes of the start position of the fields
-    uint16_t           numberOfEntries; // Number of entries
 
 private:
-    // Find the entries of the message
-    void parseMessage();
+    static_assert( MSGPARSERBUFFERSIZE > 0 && MSGPARSERBUFFERSIZE <= 128 && ( MSGPARSERBUFFERSIZE & (MSGPARSERBUFFERSIZE-1) ) == 0, 
+        "MSGPARSERBUFFERSIZE must be a power of 2, up to 128" );
+    static_assert( MSGPARSERMAXSIZE > 1 && MSGPARSERMAXSIZE <= 255, "MSGPARSERMAXSIZE must be within 2 and 255" );
+    static_assert( MSGPARSERMAXFIELDS > 0 && MSGPARSERMAXFIELDS <= MSGPARSERMAXSIZE/2, "MSGPARSERMAXFIELDS must be within 1 and MSGPARSERMAXSIZE/2" );
+
+    // Decoding of an entry (see the note about the decoding of the entries)
+    struct Entry
+    {
+        uint32_t       magnitude; // Digits of the entry as an integer, without the sign and the decimal point
+        int8_t          decimals; // Number of digits after the decimal point (-1 if there is no decimal point)
+        bool            negative; // True if the entry starts with '-'
+        EntryStatus       status; // Status of the decoding
+    };
+
+    // Decodes the next character of the entry
+    static void decode(Entry& entry, char ch, bool isFirst);
+
+    // States of the parser (see the note about the parsing)
+    enum class State : uint8_t
+    {
+        searching, // Waiting for 'BS'
+        reading    // Reading the message
+    };
+
+    char   stream[MSGPARSERBUFFERSIZE]; // The incoming characters (ring buffer)
+    uint8_t                   head {0}; // Number of characters appended (modulo 256)
+    uint8_t                   tail {0}; // Number of characters consumed (modulo 256)
+    State    state {State::searching}; // Current state of the parser
+    char         msg[MSGPARSERMAXSIZE]; // The message (entries separated by null characters)
+    uint8_t                 length {0}; // Number of characters of the message
+    uint8_t idxvec[MSGPARSERMAXFIELDS]; // Indexes of the start position of the fields
+    Entry  entries[MSGPARSERMAXFIELDS]; // Decoding of the fields
+    uint8_t          numberOfFields {0}; // Number of fields of the message being read
+    uint8_t         numberOfEntries {0}; // Number of entries of the last message found
 };
 
-#endif // MESSAGEPARSER_H
\ No newline at end of file
+#endif // MESSAGEPARSER_H
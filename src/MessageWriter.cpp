@@ -0,0 +1,361 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "MessageWriter.h"
+#include "ParametersStatic.h"
+#include "Crc16.h"
+
+
+// Formats of the messages, indexed by their codes (see the note about the message table in the header)
+#define X(name, code, format) static const char format_##name[] PROGMEM = format;
+RROCKET_OUTPUT_MESSAGES(X)
+#undef X
+
+static const char* const messageFormats[] PROGMEM = {
+#define X(name, code, format) format_##name,
+  RROCKET_OUTPUT_MESSAGES(X)
+#undef X
+};
+
+// The codes of the table must be sequential, since they index the formats
+#define X(name, code, format) code,
+static constexpr uint8_t messageCodes[] {RROCKET_OUTPUT_MESSAGES(X)};
+#undef X
+static constexpr uint8_t numberOfMessages {sizeof(messageCodes)};
+static constexpr bool areSequential(uint8_t i)
+{
+  return ( i == numberOfMessages || ( messageCodes[i] == i && areSequential(i+1) ) );
+}
+static_assert(areSequential(0), "The codes of RROCKET_OUTPUT_MESSAGES must be sequential, starting at 0");
+
+
+// Powers of 10 of the digits of uint32_t, used to format the decimals without divisions
+static const uint32_t powersOf10[] PROGMEM = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 
+  1000000UL, 10000000UL, 100000000UL, 1000000000UL};
+
+
+void MessageWriter::start(uint8_t code, Priority priority)
+{
+  this->code = code;
+  this->priority = priority;
+  format = ( code < numberOfMessages ? (const char*) pgm_read_ptr(&messageFormats[code]) : nullptr );
+  lastType = 'i';
+  decimals = 0;
+  isMasked = false;
+  length = 0;
+
+  if ( protocol == Protocol::ascii )
+  {
+    putChar('<');
+    putDecimal(code, 0);
+  }
+}
+
+
+void MessageWriter::writePart()
+{
+  // A message longer than the buffer is written in parts (see the note about the transmission)
+  priority = Priority::high;
+  writeBuffer();
+}
+
+
+void MessageWriter::putDecimal(uint32_t value, uint8_t decimals)
+{
+  /*
+    Each digit is the number of times its power of 10 can be subtracted from the value, so 
+    the digits are exact and no division is needed. The leading zeros are skipped, except 
+    those up to the units.
+  */
+  uint8_t i = sizeof(powersOf10)/sizeof(powersOf10[0]) - 1;
+  while ( i > decimals && value < pgm_read_dword(&powersOf10[i]) ) i--;
+
+  while ( true )
+  {
+    uint32_t power = pgm_read_dword(&powersOf10[i]);
+    char digit = '0';
+    while ( value >= power )
+    {
+      value -= power;
+      digit++;
+    }
+    putChar(digit);
+    if ( i == 0 ) break;
+    if ( i == decimals ) putChar('.');
+    i--;
+  }
+}
+
+
+void MessageWriter::writeBuffer()
+{
+  if ( Serial.availableForWrite() < length )
+  {
+    uint32_t startTime = micros();
+    Serial.write(buffer, length);
+    blockedTime += micros() - startTime;
+  }
+  else
+  {
+    Serial.write(buffer, length);
+  }
+  numberOfBytesSent += length;
+  length = 0;
+}
+
+
+char MessageWriter::nextType()
+{
+  while ( true )
+  {
+    // Fields beyond the format are sent as int32_t (or as the repeated type, see '*')
+    char type = ( format != nullptr ? pgm_read_byte(format) : '\0' );
+    if ( type == '\0' ) return lastType;
+
+    format++;
+
+    // Number of decimals of a fixed-point field
+    decimals = 0;
+    char next = pgm_read_byte(format);
+    if ( next >= '0' && next <= '9' )
+    {
+      decimals = next - '0';
+      format++;
+      next = pgm_read_byte(format);
+    }
+
+    if ( next == '*' )
+    {
+      // The type is repeated up to the end of the message
+      format = nullptr;
+    }
+    lastType = type;
+
+    if ( ! isMasked ) return type;
+
+    // The fields absent from the mask are skipped (see the type m)
+    bool isPresent = ( fieldMask & 1 );
+    fieldMask >>= 1;
+    if ( isPresent ) return type;
+  }
+}
+
+
+void MessageWriter::putBytes(uint32_t value, uint8_t n)
+{
+  for (uint8_t i = 0; i < n && length < MSGWRITERMAXPAYLOAD; ++i)
+  {
+    buffer[headerSize + length++] = (uint8_t)( value >> (8*i) );
+  }
+}
+
+
+void MessageWriter::putInteger(uint32_t value, char type)
+{
+  switch (type)
+  {
+    case 'b': case 'B': case 'c': case 'm': putBytes(value, 1); break;
+    case 'h': case 'H': case 'E':           putBytes(value, 2); break;
+    default:                                putBytes(value, 4); break;
+  }
+}
+
+
+void MessageWriter::addSigned(int32_t value)
+{
+  char type = nextType();
+
+  if ( protocol == Protocol::ascii )
+  {
+    putChar(',');
+    if ( value < 0 )
+    {
+      putChar('-');
+      putDecimal(0UL - (uint32_t) value, decimals);
+    }
+    else
+    {
+      putDecimal((uint32_t) value, decimals);
+    }
+  }
+  else
+  {
+    putInteger((uint32_t) value, type);
+  }
+}
+
+
+void MessageWriter::addUnsigned(uint32_t value)
+{
+  char type = nextType();
+
+  if ( type == 'm' )
+  {
+    // The next fields are present only if their bits are set
+    fieldMask = (uint8_t) value;
+    isMasked = true;
+  }
+
+  if ( protocol == Protocol::ascii )
+  {
+    putChar(',');
+    if ( type == 'E' )
+    {
+      // Shows the errors in the log (see the error table in ParametersStatic.h)
+      if ( value == 0 ) putChar('0');
+      for (uint8_t i = 1; i < 16; ++i)
+      {
+        if ( value & ( 1UL << i ) )
+        {
+          putDecimal(i, 0);
+          putChar(';');
+        }
+      }
+    }
+    else
+    {
+      putDecimal(value, decimals);
+    }
+  }
+  else
+  {
+    putInteger(value, type);
+  }
+}
+
+
+void MessageWriter::add(char value)
+{
+  nextType();
+
+  if ( protocol == Protocol::ascii )
+  {
+    putChar(',');
+    putChar(value);
+  }
+  else
+  {
+    putBytes((uint8_t) value, 1);
+  }
+}
+
+
+void MessageWriter::add(const char* value)
+{
+  nextType();
+
+  if ( protocol == Protocol::ascii )
+  {
+    putChar(',');
+    for (; *value != '\0'; ++value)
+    {
+      putChar(*value);
+    }
+    return;
+  }
+  for (; *value != '\0'; ++value)
+  {
+    putBytes((uint8_t) *value, 1);
+  }
+}
+
+
+void MessageWriter::add(const __FlashStringHelper* value)
+{
+  nextType();
+
+  const char* p = (const char*) value;
+  if ( protocol == Protocol::ascii )
+  {
+    putChar(',');
+  }
+  for (char c = pgm_read_byte(p); c != '\0'; c = pgm_read_byte(++p))
+  {
+    if ( protocol == Protocol::ascii )
+    {
+      putChar(c);
+    }
+    else
+    {
+      putBytes((uint8_t) c, 1);
+    }
+  }
+}
+
+
+void MessageWriter::add(const uint8_t* data, uint8_t n)
+{
+  nextType();
+
+  if ( protocol == Protocol::ascii )
+  {
+    static const char hexDigits[] PROGMEM = "0123456789ABCDEF";
+    putChar(',');
+    for (uint8_t i = 0; i < n; ++i)
+    {
+      putChar(pgm_read_byte(&hexDigits[data[i] >> 4]));
+      putChar(pgm_read_byte(&hexDigits[data[i] & 0x0F]));
+    }
+    return;
+  }
+  for (uint8_t i = 0; i < n; ++i)
+  {
+    putBytes(data[i], 1);
+  }
+}
+
+
+void MessageWriter::end()
+{
+  if ( protocol == Protocol::ascii )
+  {
+    putChar('>');
+    putChar('\r');
+    putChar('\n');
+  }
+  else
+  {
+    // Frame: sync | code | length | payload | CRC (see the note about the binary frames)
+    uint16_t crc = crc16Update(crc16Initial, code);
+    crc = crc16Update(crc, length);
+    crc = crc16(buffer + headerSize, length, crc);
+
+    buffer[0] = sync;
+    buffer[1] = code;
+    buffer[2] = length;
+    length += headerSize;
+    buffer[length++] = (uint8_t)( crc & 0xFF );
+    buffer[length++] = (uint8_t)( crc >> 8 );
+  }
+
+  // Low priority messages are dropped instead of waiting for room in the transmit buffer
+  if ( priority == Priority::low && Serial.availableForWrite() < length )
+  {
+    numberOfDroppedMessages++;
+    length = 0;
+    return;
+  }
+  writeBuffer();
+}
@@ -0,0 +1,249 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef MESSAGEWRITER_H
+#define MESSAGEWRITER_H
+
+#include "Arduino.h"
+
+#define MSGWRITERMAXPAYLOAD 64 // Maximum number of bytes of the payload of a binary frame
+
+#ifndef MSGWRITERBUFFERSIZE
+#define MSGWRITERBUFFERSIZE (MSGWRITERMAXPAYLOAD+5) // Number of bytes of the buffer of the message (a whole binary frame)
+#endif
+
+/*
+
+  MessageWriter sends the output messages through the serial port, either as ASCII text
+  <code,field1,field2,...> or as binary frames (see the note about the binary frames).
+  
+  Usage:
+    writer.start(ocode::x);
+    writer.add(value1);
+    writer.add(value2);
+    writer.end();
+  or, for messages with up to one field,
+    writer.send(ocode::x, value1);
+
+*/
+
+/*
+  Note about the transmission
+  ---------------------------
+
+  Serial.write blocks while the transmit buffer of the serial port is full, so the messages are
+  encoded into a buffer and written at once by end(), when their size is known. The ASCII 
+  numbers are formatted directly into the buffer by integer operations only (see putDecimal), 
+  so there is no float formatting: the floats are converted to fixed-point fields. The messages have
+  one of two priorities:
+    - high: the message is always sent. If the transmit buffer has no room for it, the writer 
+      waits, and the time spent is accounted as blocked time;
+    - low (telemetry): the message is sent only if the transmit buffer has room for it. Otherwise,
+      it is dropped and counted instead of delaying the control loop. The message dropped is the 
+      one being finished, i.e. the newest one: the older messages already in the transmit buffer
+      are still sent.
+  An ASCII message longer than the buffer is written in parts, as a high priority one.
+  The number of bytes sent, the number of messages dropped and the blocked time are shown by
+  icode::readTxStatistics.
+*/
+
+/*
+  Note about the message table
+  ----------------------------
+
+  The codes of the output messages and the types of their fields are defined by a single table,
+  RROCKET_OUTPUT_MESSAGES (see ParametersStatic.h), from which the ocode namespace is generated.
+  The types follow the format characters of the Python struct module:
+    b/B: int8_t/uint8_t, h/H: int16_t/uint16_t, i/I: int32_t/uint32_t, c: char,
+    s: string (up to the end of the message),
+    x: array of bytes (up to the end of the message, shown as hexadecimal digits in ASCII),
+    m: mask (uint8_t) of the fields that follow it. Bit i is set if the i-th field after the mask
+       is present in the message. The absent fields are not sent,
+    E: error log (uint16_t, shown as the list of the errors in ASCII, e.g. 1;3;),
+    *: the previous type is repeated up to the end of the message.
+  A digit after an integer type is the number of decimals of a fixed-point field: the integer v 
+  of a field i2 is sent as is in binary and shown as v/100 in ASCII (e.g., 10 is shown as 0.10).
+  The table is used to encode the binary frames and, in both protocols, by the host decoder
+  (see test/rrocketprotocol.py), which reads it from ParametersStatic.h.
+*/
+
+/*
+  Note about the binary frames
+  ----------------------------
+
+  Each message is sent as
+    sync (0xA5) | code | length | payload (length bytes) | CRC (2 bytes)
+  The fields of the payload are little-endian and their types are given by the message table.
+  The CRC is the CRC-16/CCITT-FALSE (see Crc16.h) of the code, the length and the payload, 
+  sent as little-endian. Since the ASCII text has no byte above 0x7F, the sync byte also 
+  separates the frames from any ASCII text in the stream. The protocol is chosen by the host
+  at connect time (see icode::setProtocol) and the ASCII protocol is the default.
+*/
+
+// Converts a float to a fixed-point integer with the given number of decimals (rounded), e.g., toFixed(0.1, 2) = 10
+constexpr int32_t toFixed(float value, uint8_t decimals)
+{
+  return ( decimals == 0 ? (int32_t)( value < 0 ? value - 0.5f : value + 0.5f ) : toFixed(value * 10, decimals - 1) );
+}
+
+class MessageWriter
+{
+  public:
+
+    // Protocols of the output messages
+    enum class Protocol : uint8_t
+    {
+      ascii, // <code,field1,field2,...>
+      binary // See the note about the binary frames
+    };
+
+    // Priorities of the output messages (see the note about the transmission)
+    enum class Priority : uint8_t
+    {
+      high, // Always sent, even if the writer must wait
+      low   // Dropped if the transmit buffer is full
+    };
+
+    // Sets the protocol of the next messages
+    void setProtocol(Protocol protocol){this->protocol = protocol;};
+
+    // Returns the protocol of the messages
+    Protocol getProtocol(){return protocol;};
+
+    // Starts a message
+    void start(uint8_t code, Priority priority = Priority::high);
+
+    // Adds an integer field to the message
+    template <class T>
+    void add(T value)
+    {
+      // Signed and unsigned types are distinguished without <type_traits>, which is not available in AVR
+      if ( (T)(-1) < (T)(0) ) 
+      {
+        addSigned((int32_t) value);
+      }
+      else
+      {
+        addUnsigned((uint32_t) value);
+      }
+    }
+
+    // Adds a character field to the message
+    void add(char value);
+
+    // Floats must be converted to fixed-point fields (see toFixed)
+    void add(float value) = delete;
+    void add(double value) = delete;
+
+    // Adds a string field to the message
+    void add(const char* value);
+
+    // Adds a string field in the program memory to the message
+    void add(const __FlashStringHelper* value);
+
+    // Adds an array of n bytes to the message (type x)
+    void add(const uint8_t* data, uint8_t n);
+
+    // Finishes the message and sends it
+    void end();
+
+    // Sends a message without fields
+    void send(uint8_t code)
+    {
+      start(code);
+      end();
+    }
+
+    // Sends a message with a single field
+    template <class T>
+    void send(uint8_t code, T value)
+    {
+      start(code);
+      add(value);
+      end();
+    }
+
+    // Returns the number of bytes sent
+    uint32_t getNumberOfBytesSent(){return numberOfBytesSent;};
+
+    // Returns the number of low priority messages dropped
+    uint16_t getNumberOfDroppedMessages(){return numberOfDroppedMessages;};
+
+    // Returns the time spent waiting for room in the transmit buffer (microseconds)
+    uint32_t getBlockedTime(){return blockedTime;};
+
+    // Sync byte of the binary frames
+    static constexpr uint8_t sync {0xA5};
+
+  private:
+
+    // Adds a signed integer field to the message
+    void addSigned(int32_t value);
+
+    // Adds an unsigned integer field to the message
+    void addUnsigned(uint32_t value);
+
+    // Returns the type of the next field of the message (see the note about the message table)
+    char nextType();
+
+    // Appends a character to the ASCII message
+    void putChar(char c)
+    {
+      if ( length == MSGWRITERBUFFERSIZE ) writePart();
+      buffer[length++] = (uint8_t) c;
+    }
+
+    // Writes the part of an ASCII message that filled the buffer
+    void writePart();
+
+    // Appends the decimal digits of value to the ASCII message, with a point before the last 'decimals' digits
+    void putDecimal(uint32_t value, uint8_t decimals);
+
+    // Writes the buffer to the serial port, waiting for room if necessary, and empties it
+    void writeBuffer();
+
+    // Appends the n least significant bytes of value to the payload (little-endian)
+    void putBytes(uint32_t value, uint8_t n);
+
+    // Appends an integer to the payload with the size of the type
+    void putInteger(uint32_t value, char type);
+
+    Protocol     protocol {Protocol::ascii}; // Protocol of the messages
+    Priority     priority {Priority::high}; // Priority of the current message
+    uint8_t                      code {0}; // Code of the current message
+    const char*          format {nullptr}; // Format of the current message (in the program memory)
+    char                   lastType {'i'}; // Type of the last field
+    uint8_t                  decimals {0}; // Number of decimals of the last field (fixed-point)
+    uint8_t                 fieldMask {0}; // Bits of the remaining fields after a mask (see the type m)
+    bool                 isMasked {false}; // True if the message has a mask of fields
+    uint8_t  buffer[MSGWRITERBUFFERSIZE]; // Current message (ASCII text or binary frame)
+    static constexpr uint8_t headerSize {3}; // Bytes of the binary frame before the payload (sync, code and length)
+    uint8_t                    length {0}; // Number of bytes of the payload (binary) or of the buffer (ASCII)
+    uint32_t        numberOfBytesSent {0}; // Number of bytes sent
+    uint16_t  numberOfDroppedMessages {0}; // Number of low priority messages dropped
+    uint32_t              blockedTime {0}; // Time spent waiting for room in the transmit buffer (microseconds)
+};
+
+#endif // MESSAGEWRITER_H
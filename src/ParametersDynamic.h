@@ -27,16 +27,49 @@
 #define DYNAMICPARAMETERS
 
 #include <inttypes.h>
+#include "ParametersStatic.h"
+
+/*
+  Note about the parameter registry
+  ---------------------------------
+  The flight parameters are defined by a single table, RROCKET_FLIGHT_PARAMETERS, from which are 
+  generated the FlightParameters structure (and so the layout of the parameters in the permanent 
+  memory, see Memory.h), the icodes of the set commands, the dispatch of these commands, their 
+  validation and the messages that show the parameters (see RecoverySystem.cpp). The columns are
+    name:       name of the field of FlightParameters and of the ocode that shows it (see RROCKET_OUTPUT_MESSAGES),
+    setter:     name of the icode that sets the parameter,
+    setterCode: code of the set command (a code used by another command is a duplicate case of the switch of the commands),
+    value:      default value,
+    minimum:    minimum value,
+    maximum:    maximum value,
+    units:      units of the parameter, shown by icode::readFlightParameterTable.
+  All the parameters are int16_t. The order of the table is the order of the fields in the 
+  permanent memory and in the message that sets all the parameters (icode::setFlightParameters).
+  Adding a parameter takes a line in this table and its ocode in RROCKET_OUTPUT_MESSAGES.
+*/
+#define RROCKET_FLIGHT_PARAMETERS(X) \
+  X(speedForLiftoffDetection,        setSpeedForLiftoffDetection,         8,   30,    1,  340, "m/s") /* Speed for liftoff detection */ \
+  X(speedForFallDetection,           setSpeedForFallDetection,            9,   30,    1,  340, "m/s") /* Speed for fall detection */ \
+  X(speedForApogeeDetection,         setSpeedForApogeeDetection,         10,    0,  -50,   50, "m/s") /* Speed for apogee detection */ \
+  X(parachuteDeploymentAltitude,     setParachuteDeploymentAltitude,     11,  200,    0, 3000, "m")   /* Altitude to deploy the main parachute */ \
+  X(displacementForLandingDetection, setDisplacementForLandingDetection, 12,    3,    1,  100, "m")   /* Displacement for landing detection */ \
+  X(maxNumberOfDeploymentAttempts,   setMaxNumberOfDeploymentAttempts,   13,    3,    1,   10, "")    /* Maximum number of deployment attempts */ \
+  X(timeStepScaler,                  setTimeStepScaler,                  14,   10,    1,  100, "")    /* Scaler for adaptive deltaT */ \
+  X(timeForLandingDetection,         setTimeForLandingDetection,         17, 3200, ParametersStatic::deltaT, \
+    ParametersStatic::deltaT * ( ParametersStatic::maxLandingWindow - 1 ), "ms") /* Length of the time window for landing detection (limited by the altitude vector) */
 
 struct FlightParameters
 {
-  int16_t             speedForLiftoffDetection  {30}; // Speed for liftoff detection (m/s)
-  int16_t                speedForFallDetection  {30}; // Speed for fall detection (m/s)
-  int16_t              speedForApogeeDetection   {0}; // Speed for apogee detection (m/s)
-  int16_t          parachuteDeploymentAltitude {200}; // Altitude to deploy the main parachute (m)
-  int16_t      displacementForLandingDetection   {3}; // Displacement for landing detection (meter)
-  int16_t        maxNumberOfDeploymentAttempts   {3}; // Maximum number of deployment attempts
-  int16_t                       timeStepScaler  {10}; // Scaler for adaptive deltaT
+#define X(name, setter, setterCode, value, minimum, maximum, units) int16_t name {value};
+  RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
 };
 
-#endif
\ No newline at end of file
+namespace icode
+{
+#define X(name, setter, setterCode, value, minimum, maximum, units) static constexpr uint8_t setter {setterCode};
+  RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+}
+
+#endif
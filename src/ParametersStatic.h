@@ -27,6 +27,17 @@
 #define PARAMETERSSTATIC_H
 #include "Arduino.h"
 
+/*
+  Buses available to communicate with the barometer
+    i2cStandard: I2C at 100 kHz (default wiring of rRocket-EZ)
+        i2cFast: I2C at 400 kHz (fast mode)
+            spi: hardware SPI with chip selects at pinBarometerCS
+  Warning: on the Arduino Nano, the hardware SPI uses the pins 11 (MOSI), 12 (MISO) and 13 (SCK), 
+  which are used by the buzzer, the drogue chute and the led in the rRocket-EZ board. 
+  The SPI bus is intended only for boards with a different pinout.
+*/
+enum class BarometerBus : uint8_t {i2cStandard, i2cFast, spi};
+
 namespace ParametersStatic
 {
   static constexpr char                 softwareVersion[] {"1.7.2"}; // Version of this software
@@ -35,14 +46,23 @@ namespace ParametersStatic
   static constexpr int                              pinButton  {10}; // Pin of button
   static constexpr int                         pinDrogueChute  {12}; // Pin to trigger the auxiliary recovery system (at apogee-displacementForRecoveryDetection)
   static constexpr int                           pinParachute   {3}; // Pin to trigger the main recovery system (at parachuteDeploymentAltitude)
+  static constexpr BarometerBus                     barometerBus {BarometerBus::i2cStandard}; // Bus used to communicate with the barometer
+  static constexpr uint8_t             maxNumberOfBarometers  {2}; // Maximum number of redundant barometers (see Barometer.h)
+  static constexpr int                      pinBarometerCS[] {9, 8}; // Chip select pins of the barometers (only for BarometerBus::spi)
+  static constexpr uint32_t           barometerSPIClock {4000000}; // Clock of the SPI bus (Hz) (only for BarometerBus::spi)
   static constexpr uint32_t             actuatorDischargeTime {500}; // Time to discharge the capacitor of the actuator to deploy the parachute and the drogue (milliseconds)
   static constexpr uint32_t            capacitorRechargeTime {1000}; // Time to recharge the capacitor of the actuator (milliseconds)
   static constexpr uint8_t                                  N  {32}; // Number of altitude measurements stored during the flight (must be a multiple of 4)
+  static constexpr uint8_t                  maxLandingWindow  {33}; // Maximum number of altitudes of the window of the landing detection (limits timeForLandingDetection)
   static constexpr uint16_t                            deltaT {100}; // Time step between measurements (ms)
+  static constexpr bool                   acquisitionTimer {true}; // Reads the barometer at the tick of Timer1 instead of polling it (only AVR, see Sampler.h)
+  static constexpr uint8_t           acquisitionOversampling  {1}; // Number of barometer readings per time step deltaT (1 to 5, deltaT must be a multiple of it)
   static constexpr float                               kfStdExp {2}; // Standard deviation of altitude measurements (m)
   static constexpr float                           kfStdModSub {32}; // Standard deviation of Kalman filter model for subsonic flow (m/s3)
   static constexpr float                          kfStdModTra {0.1}; // Standard deviation of Kalman filter model for transonic flow (m/s3)
   static constexpr float                            kfdadt_ref {32}; // Parameter of Alpha filter(m/s3)
+  static constexpr float               padBaselineTimeConstant {60}; // Time constant of the tracker of the ground level drift before liftoff (s)
+  static constexpr uint8_t                       logBlockSize {32}; // Number of bytes of each block of the log download (see icode::readLogBlocks)
 }
 
 
@@ -72,6 +92,7 @@ namespace error
   static constexpr uint16_t AltitudeNegativeOverflow        {2 << 2}; // Error 3
   static constexpr uint16_t AltitudePositiveOverflow        {2 << 3}; // Error 4
   static constexpr uint16_t FlightStartedWithNonEmptyMemory {2 << 4}; // Error 5
+  static constexpr uint16_t AltitudeHistorySaturation       {2 << 5}; // Error 6
 }
 
 
@@ -88,49 +109,83 @@ namespace icode
   static constexpr uint8_t readFlightReport                    {5};
   static constexpr uint8_t setSimulationMode                   {6};
   static constexpr uint8_t setSimulatedFlightAltitude          {7};
-  static constexpr uint8_t setSpeedForLiftoffDetection         {8};
-  static constexpr uint8_t setSpeedForFallDetection            {9};
-  static constexpr uint8_t setSpeedForApogeeDetection         {10};
-  static constexpr uint8_t setParachuteDeploymentAltitude     {11};
-  static constexpr uint8_t setDisplacementForLandingDetection {12};
-  static constexpr uint8_t setMaxNumberOfDeploymentAttempts   {13};
-  static constexpr uint8_t setTimeStepScaler                  {14};
+  // Codes 8 to 14 and 17 set the pending flight parameters, which are shown by code 1 and written and applied by code 2 (see RROCKET_FLIGHT_PARAMETERS in ParametersDynamic.h)
+  static constexpr uint8_t runBarometerBenchmark              {15};
+  static constexpr uint8_t readAcquisitionStatistics          {16};
+  static constexpr uint8_t readTaskStatistics                 {18};
+  static constexpr uint8_t readStageTimings                   {19};
+  static constexpr uint8_t setFlightParameters                {20};
+  static constexpr uint8_t setProtocol                        {21};
+  static constexpr uint8_t readLogInfo                        {22};
+  static constexpr uint8_t readLogBlocks                      {23};
+  static constexpr uint8_t readReportProgress                 {24};
+  static constexpr uint8_t cancelReport                       {25};
+  static constexpr uint8_t readTxStatistics                   {26};
+  static constexpr uint8_t setTelemetry                       {27};
+  static constexpr uint8_t readFlightParameterTable           {28};
 }
 
 /*
-  Output communication codes 
+  Output communication codes and the format of their fields (see the note about the message table in MessageWriter.h)
 */
+#define RROCKET_OUTPUT_MESSAGES(X) \
+  X(errorLog,                         0,   "E")               \
+  X(requestSimulatedAltitude,         1,   "i")               \
+  X(simulatedFlightState,             2,   "iiiic")           \
+  X(flightPath,                       3,   "ii")              \
+  X(firmwareVersion,                  4,   "s")               \
+  X(simulatedMode,                    5,   "B")               \
+  X(startedInitialization,            6,   "")                \
+  X(finishedInitialization,           7,   "")                \
+  X(stardedSendingMemoryReport,       8,   "")                \
+  X(finishedSendingMemoryReport,      9,   "")                \
+  X(liftoffEvent,                     10,  "i")               \
+  X(drogueEvent,                      11,  "i")               \
+  X(parachuteEvent,                   12,  "i")               \
+  X(landedEvent,                      13,  "i")               \
+  X(actuatorDischargeTime,            14,  "I")               \
+  X(capacitorRechargeTime,            15,  "I")               \
+  X(N,                                16,  "B")               \
+  X(deltaT,                           17,  "H")               \
+  X(speedForLiftoffDetection,         18,  "h")               \
+  X(speedForFallDetection,            19,  "h")               \
+  X(speedForApogeeDetection,          20,  "h")               \
+  X(parachuteDeploymentAltitude,      21,  "h")               \
+  X(displacementForLandingDetection,  22,  "h")               \
+  X(maxNumberOfDeploymentAttempts,    23,  "h")               \
+  X(timeStepScaler,                   24,  "h")               \
+  X(kfStdExp,                         25,  "i2")              \
+  X(kfStdModSub,                      26,  "i2")              \
+  X(kfStdModTra,                      27,  "i2")              \
+  X(kfDadt_ref,                       28,  "i2")              \
+  X(barometerReadTime,                29,  "BI")              \
+  X(acquisitionOversampling,          30,  "B")               \
+  X(staleReadings,                    31,  "II")              \
+  X(barometerHealth,                  32,  "BBi")             \
+  X(groundLevel,                      33,  "i")               \
+  X(sampleOverruns,                   34,  "HH")              \
+  X(timeForLandingDetection,          35,  "h")               \
+  X(freeMemory,                       36,  "h")               \
+  X(taskStatistics,                   37,  "BIH")             \
+  X(stageTiming,                      38,  "BHHHHH*")         \
+  X(deploymentTiming,                 39,  "BIIII")           \
+  X(startupTime,                      40,  "I")               \
+  X(rejectedParameter,                41,  "i")               \
+  X(invalidEntry,                     42,  "BB")              \
+  X(protocol,                         43,  "B")               \
+  X(logInfo,                          44,  "HBHHHHHHH")       \
+  X(logBlock,                         45,  "HHx")             \
+  X(reportProgress,                   46,  "HH")              \
+  X(txStatistics,                     47,  "IHI")             \
+  X(telemetry,                        48,  "mHihhcB")         \
+  X(telemetrySettings,                49,  "BB")              \
+  X(flightParameterInfo,              50,  "BBhhhs")
+
 namespace ocode
 {
-  static constexpr uint8_t errorLog                         {0};
-  static constexpr uint8_t requestSimulatedAltitude         {1};
-  static constexpr uint8_t simulatedFlightState             {2};
-  static constexpr uint8_t flightPath                       {3};
-  static constexpr uint8_t firmwareVersion                  {4};
-  static constexpr uint8_t simulatedMode                    {5};
-  static constexpr uint8_t startedInitialization            {6};
-  static constexpr uint8_t finishedInitialization           {7};
-  static constexpr uint8_t stardedSendingMemoryReport       {8};
-  static constexpr uint8_t finishedSendingMemoryReport      {9};
-  static constexpr uint8_t liftoffEvent                    {10};
-  static constexpr uint8_t drogueEvent                     {11};
-  static constexpr uint8_t parachuteEvent                  {12};
-  static constexpr uint8_t landedEvent                     {13};
-  static constexpr uint8_t actuatorDischargeTime           {14};
-  static constexpr uint8_t capacitorRechargeTime           {15};
-  static constexpr uint8_t N                               {16};
-  static constexpr uint8_t deltaT                          {17}; 
-  static constexpr uint8_t speedForLiftoffDetection        {18};
-  static constexpr uint8_t speedForFallDetection           {19};
-  static constexpr uint8_t speedForApogeeDetection         {20};
-  static constexpr uint8_t parachuteDeploymentAltitude     {21}; 
-  static constexpr uint8_t displacementForLandingDetection {22};
-  static constexpr uint8_t maxNumberOfDeploymentAttempts   {23};
-  static constexpr uint8_t timeStepScaler                  {24};
-  static constexpr uint8_t kfStdExp                        {25};
-  static constexpr uint8_t kfStdModSub                     {26};
-  static constexpr uint8_t kfStdModTra                     {27};
-  static constexpr uint8_t kfDadt_ref                      {28};
-} 
+#define X(name, code, format) static constexpr uint8_t name {code};
+  RROCKET_OUTPUT_MESSAGES(X)
+#undef X
+}
 
 #endif // PARAMETERSSTATIC_H
@@ -0,0 +1,61 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "Profiler.h"
+
+#ifdef RROCKET_PROFILING
+
+Profiler profiler;
+
+void Profiler::add(ProfilerStage stage, uint32_t t)
+{
+  Statistics& s = stats[(uint8_t)stage];
+
+  // The sum is not updated after the count saturates, so that the mean remains valid
+  if ( s.count < 0xFFFF )
+  {
+    s.count++;
+    s.sum += t;
+  }
+
+  uint16_t t16 = ( t > 0xFFFF ? 0xFFFF : t );
+  if ( t16 < s.minimum ) s.minimum = t16;
+  if ( t16 > s.maximum ) s.maximum = t16;
+
+  // Bin of the histogram (see the header)
+  uint8_t i = 0;
+  for (uint32_t limit = 64; i < numberOfBins-1 && t >= limit; limit <<= 1) i++;
+  if ( s.histogram[i] < 0xFFFF ) s.histogram[i]++;
+}
+
+void Profiler::reset()
+{
+  for (uint8_t i = 0; i < numberOfStages; ++i)
+  {
+    stats[i] = Statistics();
+  }
+}
+
+#endif // RROCKET_PROFILING
@@ -0,0 +1,116 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Arduino.h"
+
+/*
+
+  Profiler measures the run time of the stages of the main loop (microseconds). For each stage, 
+  it keeps the number of runs, the minimum, the mean and the maximum run time and a histogram.
+  The bin i of the histogram counts the run times t such that 
+    64*2^(i-1) <= t < 64*2^i (microseconds),
+  the first bin counts t < 64 us and the last one counts t >= 4096 us.
+
+  The profiler is only compiled if the flag RROCKET_PROFILING is defined (see platformio.ini).
+  Otherwise, PROFILE_STAGE expands to nothing and no memory is used.
+
+  Usage: PROFILE_STAGE(stage) at the beginning of a block measures the run time up to the end of the block.
+
+*/
+
+enum class ProfilerStage : uint8_t {registerAltitude, kalmanProcess, writeAltitude, listenForMessages, stateRun, reportRecord, simulationState, numberOfStages};
+
+#ifdef RROCKET_PROFILING
+
+class Profiler
+{
+  public:
+
+    static constexpr uint8_t numberOfStages {(uint8_t)ProfilerStage::numberOfStages};
+    static constexpr uint8_t numberOfBins {8};
+
+    // Registers a run of the stage that lasted t microseconds
+    void add(ProfilerStage stage, uint32_t t);
+
+    // Clears the statistics
+    void reset();
+
+    // Returns the number of runs of the stage
+    uint16_t getCount(ProfilerStage stage){return stats[(uint8_t)stage].count;};
+
+    // Returns the minimum run time of the stage (microseconds)
+    uint16_t getMinimum(ProfilerStage stage){return stats[(uint8_t)stage].count > 0 ? stats[(uint8_t)stage].minimum : 0;};
+
+    // Returns the mean run time of the stage (microseconds)
+    uint16_t getMean(ProfilerStage stage){return stats[(uint8_t)stage].count > 0 ? stats[(uint8_t)stage].sum / stats[(uint8_t)stage].count : 0;};
+
+    // Returns the maximum run time of the stage (microseconds)
+    uint16_t getMaximum(ProfilerStage stage){return stats[(uint8_t)stage].maximum;};
+
+    // Returns the number of runs of the stage in the bin i of the histogram
+    uint16_t getHistogram(ProfilerStage stage, uint8_t i){return stats[(uint8_t)stage].histogram[i];};
+
+  private:
+
+    struct Statistics
+    {
+      uint16_t count {0};                   // Number of runs (saturated)
+      uint16_t minimum {0xFFFF};            // Minimum run time (microseconds, saturated)
+      uint16_t maximum {0};                 // Maximum run time (microseconds, saturated)
+      uint32_t sum {0};                     // Sum of the run times (microseconds)
+      uint16_t histogram[numberOfBins] {};  // Histogram of the run times (saturated)
+    };
+
+    Statistics stats[numberOfStages];
+};
+
+// Profiler of the main loop
+extern Profiler profiler;
+
+// Measures the run time of a block (see PROFILE_STAGE)
+class ProfilerScope
+{
+  public:
+    ProfilerScope(ProfilerStage stage): stage(stage), startTime(micros()) {};
+    ~ProfilerScope(){profiler.add(stage, micros() - startTime);};
+  private:
+    ProfilerStage stage;
+    uint32_t startTime;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+#define PROFILE_STAGE(stage) ProfilerScope PROFILER_CONCAT(profilerScope, __LINE__)(stage)
+
+#else
+
+#define PROFILE_STAGE(stage)
+
+#endif // RROCKET_PROFILING
+
+#endif // PROFILER_H
@@ -25,7 +25,70 @@
 
 #include "RecoverySystem.h"
 #include "ParametersStatic.h"
+#include "Profiler.h"
 #include "ParametersStatic.h"
+#include "Crc16.h"
+
+
+// Registry of the flight parameters, in the program memory (see the note about the parameter registry in ParametersDynamic.h)
+struct FlightParameterInfo
+{
+  uint8_t             icode; // Code of the command that sets the parameter
+  uint8_t             ocode; // Code of the message that shows the parameter
+  uint8_t            offset; // Position of the parameter in FlightParameters (bytes)
+  int16_t      defaultValue; // Default value
+  int16_t           minimum; // Minimum value
+  int16_t           maximum; // Maximum value
+  const char*         units; // Units (in the program memory)
+};
+
+#define X(name, setter, setterCode, value, minimum, maximum, units) static const char units_##name[] PROGMEM = units;
+RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+
+static const FlightParameterInfo flightParameterTable[] PROGMEM = {
+#define X(name, setter, setterCode, value, minimum, maximum, units) {setterCode, ocode::name, offsetof(FlightParameters, name), value, minimum, maximum, units_##name},
+  RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+};
+static constexpr uint8_t numberOfFlightParameters {sizeof(flightParameterTable)/sizeof(flightParameterTable[0])};
+static_assert(sizeof(FlightParameters) == numberOfFlightParameters*sizeof(int16_t), "The flight parameters must be int16_t");
+static_assert(numberOfFlightParameters + 2 <= MSGPARSERMAXFIELDS, "The message that sets all the flight parameters exceeds MSGPARSERMAXFIELDS");
+
+#define X(name, setter, setterCode, value, minimum, maximum, units) \
+  static_assert(value >= minimum && value <= maximum, "The default value of " #name " is out of its range");
+RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+
+// Indexes of the flight parameters in the registry
+namespace flightParameter
+{
+  enum : uint8_t
+  {
+#define X(name, setter, setterCode, value, minimum, maximum, units) name,
+    RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+  };
+}
+
+// Reads the entry i of the registry from the program memory
+static FlightParameterInfo readFlightParameterInfo(uint8_t i)
+{
+  FlightParameterInfo info;
+  memcpy_P(&info, &flightParameterTable[i], sizeof(info));
+  return info;
+}
+
+// Returns the parameter at the offset (bytes) of the structure p
+static int16_t& flightParameterAt(FlightParameters& p, uint8_t offset)
+{
+  return *(int16_t*)( (uint8_t*) &p + offset );
+}
+
+static int16_t flightParameterAt(const FlightParameters& p, uint8_t offset)
+{
+  return *(const int16_t*)( (const uint8_t*) &p + offset );
+}
 
 
 void RecoverySystem::begin(bool simulationMode)
@@ -34,6 +97,9 @@ void RecoverySystem::begin(bool simulationMode)
   this->simulationMode = simulationMode;
   waitingForSimulatedAltitude = false;
 
+  // The barometer must not be read by the timer while it is (re)initialized
+  sampler.stop();
+
   pinMode(ParametersStatic::pinLed, OUTPUT);
   timeOfTheLastMessage = millis();
   parser.begin();
@@ -41,11 +107,20 @@ void RecoverySystem::begin(bool simulationMode)
   // Initializing button
   button.begin(ParametersStatic::pinButton);
 
+  // Initializing the signaler of numbers (stops any number being shown)
+  signaler.begin(ParametersStatic::pinLed, ParametersStatic::pinBuzzer);
+
   // Initializing EEPROM memory
   memory.begin();  
 
-  // Reading flight parameters from permanent memory
+  // Reading flight parameters from permanent memory (the factory parameters are used if they are not valid, e.g. a blank EEPROM)
   flightParameters = memory.readFlightParameters();
+  if ( ! validateFlightParameters(flightParameters) )
+  {
+    flightParameters = FlightParameters();
+  }
+  pendingFlightParameters = flightParameters;
+  hasPendingFlightParameters = false;
 
   // Show initialization message
   showInitMessage(flightParameters);
@@ -67,78 +142,344 @@ void RecoverySystem::begin(bool simulationMode)
     state = RecoverySystemState::readyToLaunch;
   }
 
-  // Initializing the barometer (this module is critical, so its initialization must be garanteed)
-  if ( ! barometer.begin() )
+  // The barometer, the actuator and the altitude vector are initialized by the run() method (see the note about the initialization in the header)
+  initializationStartTime = millis();
+  initializationState = InitializationState::barometer;
+  nextInitializationTime = initializationStartTime;
+  hasInitializationFailed = false;
+}
+
+
+void RecoverySystem::initialize()
+{
+  switch (initializationState)
   {
-    // Registering error
-    memory.writeErrorLog(error::BarometerInitializationFailure);
-    tone(ParametersStatic::pinBuzzer,600);
-    showErrorLog();
+    case InitializationState::barometer:
+    {
+      // Initializing the barometer (this module is critical, so its initialization must be garanteed)
+      if ( (int32_t)( millis() - nextInitializationTime ) < 0 ) break;
 
-    while ( ! barometer.begin() )
-    { 
-      delay(100);
+      if ( barometer.begin() )
+      {
+        if ( hasInitializationFailed ) noTone(ParametersStatic::pinBuzzer);
+        hasInitializationFailed = false;
+        initializationState = InitializationState::actuator;
+      }
+      else
+      {
+        if ( ! hasInitializationFailed )
+        {
+          // Registering error
+          memory.writeErrorLog(error::BarometerInitializationFailure);
+          tone(ParametersStatic::pinBuzzer,600);
+          showErrorLog();
+          hasInitializationFailed = true;
+        }
+        nextInitializationTime = millis() + 100;
+      }
+      break;
     }
-    noTone(ParametersStatic::pinBuzzer);
-  }
+    case InitializationState::actuator:
+    {
+      // Initializing the actuator (this module is critical, so its initialization must be garanteed)
+      if ( (int32_t)( millis() - nextInitializationTime ) < 0 ) break;
 
-  // Initializing the actuator (this module is critical, so its initialization must be garanteed)
-  if ( ! actuator.begin() ) 
-  {
-    // Registering error
-    memory.writeErrorLog(error::ActuatorInitializationFailure);
-    tone(ParametersStatic::pinBuzzer,600);
-    showErrorLog();
+      if ( actuator.begin() )
+      {
+        if ( hasInitializationFailed ) noTone(ParametersStatic::pinBuzzer);
+        hasInitializationFailed = false;
+        startWarmUp();
+      }
+      else
+      {
+        if ( ! hasInitializationFailed )
+        {
+          // Registering error
+          memory.writeErrorLog(error::ActuatorInitializationFailure);
+          tone(ParametersStatic::pinBuzzer,600);
+          showErrorLog();
+          hasInitializationFailed = true;
+        }
+        nextInitializationTime = millis() + 100;
+      }
+      break;
+    }
+    case InitializationState::warmUp:
+    {
+      float currentAltitude = barometer.getAltitude();
+
+      // Only fresh readings are averaged
+      if ( barometer.isFresh() )
+      {
+        warmUpSum += currentAltitude;
+        warmUpCount++;
+      }
 
-    while ( ! actuator.begin() )
+      if ( warmUpCount == warmUpReadings || (int32_t)( millis() - nextInitializationTime ) >= 0 )
+      {
+        float h0 = ( warmUpCount > 0 ? warmUpSum / warmUpCount : currentAltitude );
+
+        // Seeding the altitude vector and the Kalman filter with the mean of the burst of readings
+        altitude.fill(h0);
+        newestAltitude = h0;
+        beginKalmanFilter(h0);
+
+        // The time steps start now
+        currentStep = ( (int32_t) millis() ) / ( (int32_t) deltaT );
+        currentSubStep = currentStep * oversampling;
+        flightInitialStep = currentStep;
+
+        // Starting the timer-driven readings
+        if ( ParametersStatic::acquisitionTimer )
+        {
+          sampler.begin(barometer, subDeltaT);
+        }
+
+        // Initialization finished message
+        showInitFinishedMessage();
+        finishInitialization();
+      }
+      break;
+    }
+    case InitializationState::simulatedWarmUp:
     {
-      delay(100);
+      // Giving the registerAltitude method enough time to fully populate the altitude[] vector
+      if ( currentStep <= flightInitialStep + N )
+      {
+        // Read the altitude, but do not write it to the memory
+        registerAltitude(0);
+
+        if ( currentStep > flightInitialStep + N )
+        {
+          delayedWriteIdx = 0; 
+
+          // Initialization finished message
+          showInitFinishedMessage();
+        }
+      }
+      // Given enought time to print the message of initialization finished
+      else if ( currentStep <= flightInitialStep + N + 2 )
+      {
+        // Read the altitude, but do not write it to the memory
+        registerAltitude(0);
+      }
+      else
+      {
+        finishInitialization();
+      }
+      break;
     }
-    noTone(ParametersStatic::pinBuzzer);
+    default:
+      break;
   }
-  
+}
+
+
+void RecoverySystem::startWarmUp()
+{
   // Initializing the time counter for altitude measurements
   uint32_t t0 = millis();
   currentStep = ( (int32_t) t0 ) / ( (int32_t) deltaT );
+  currentSubStep = currentStep * oversampling;
   flightInitialStep = currentStep;
   simulationInitialStep = currentStep+N+4;
+  decimatorSum = 0.0;
+  decimatorCount = 0;
+  decimatorFreshCount = 0;
+  delayedWriteIdx = 0; 
+  padBaseline = 0.0;
 
   // Pre-initializing the remainder elements of the altitude vector
-  for ( uint8_t i = 0; i <= N; ++i)
+  altitude.fill(0.0);
+  newestAltitude = 0.0;
+
+  // The landing is detected if the displacement within the last timeForLandingDetection/deltaT time steps is small enough
+  altitude.setExtremaWindow( flightParameters.timeForLandingDetection / (int16_t) deltaT + 1 );
+
+  if ( simulationMode )
+  {
+    // The simulated altitudes are requested for each time step, so the altitude vector is populated at the regular rate
+    bool isFresh;
+    beginKalmanFilter(getAltitude(isFresh));
+    initializationState = InitializationState::simulatedWarmUp;
+  }
+  else
   {
-    altitude[i] = 0.0;
+    // Burst of readings (see the note about the initialization in the header)
+    warmUpSum = 0.0;
+    warmUpCount = 0;
+    nextInitializationTime = t0 + maxWarmUpTime;
+    initializationState = InitializationState::warmUp;
   }
-  
-  // Initializing the Kalman filter
-  kalmanFilter.begin(getAltitude(), 
-    ParametersStatic::deltaT*1E-3, 
+}
+
+
+void RecoverySystem::beginKalmanFilter(float h0)
+{
+  // Initializing the Kalman filter. The filter runs at the sampling rate. The standard deviations 
+  // of the model are scaled, so that the variance accumulated within deltaT does not depend on 
+  // the number of readings per time step.
+  kalmanFilter.begin(h0, 
+    subDeltaT*1E-3, 
     ParametersStatic::kfStdExp, 
-    ParametersStatic::kfStdModSub, 
-    ParametersStatic::kfStdModTra, 
+    ParametersStatic::kfStdModSub*sqrt(oversampling), 
+    ParametersStatic::kfStdModTra*sqrt(oversampling), 
     ParametersStatic::kfdadt_ref);
+}
+
+
+void RecoverySystem::finishInitialization()
+{
+#ifdef RROCKET_PROFILING
+  profiler.reset();
+#endif
+
+  // Initializing the tasks of the main loop (see the note about the task scheduler in the header)
+  scheduler.begin(this);
+  scheduler.setTask(flightTaskPriority,        &RecoverySystem::flightTask,        0,  subDeltaT);
+  scheduler.setTask(loggingTaskPriority,       &RecoverySystem::loggingTask,       0,  deltaT);
+  scheduler.setTask(userInterfaceTaskPriority, &RecoverySystem::userInterfaceTask, 10, 100);
+  scheduler.setTask(serialTaskPriority,        &RecoverySystem::listenForMessages, 0,  5);
+  scheduler.setTask(telemetryTaskPriority,     &RecoverySystem::telemetryTask,     0,  5);
+  scheduler.setTask(reportTaskPriority,        &RecoverySystem::reportTask,        0,  5);
+  scheduler.setTask(logDownloadTaskPriority,   &RecoverySystem::logDownloadTask,   0,  5);
+
+  initializationState = InitializationState::finished;
+
+  // Showing the time spent in the initialization
+  writer.send(ocode::startupTime, millis() - initializationStartTime);
+}
+
+
+bool RecoverySystem::isOnGround()
+{
+  return ( state == RecoverySystemState::readyToLaunch || state == RecoverySystemState::recovered );
+}
 
-  // Giving the registerAltitude method enough time to fully populate the altitude[] vector
-  while ( currentStep <= flightInitialStep + N )
+
+bool RecoverySystem::validateFlightParameters(const FlightParameters& p)
+{
+  for (uint8_t i = 0; i < numberOfFlightParameters; ++i)
   {
-    // Read the altitude, but do not write it to the memory
-    registerAltitude(0);
+    FlightParameterInfo info = readFlightParameterInfo(i);
+    int16_t value = flightParameterAt(p, info.offset);
+    if ( value < info.minimum || value > info.maximum ) return false;
   }
-  delayedWriteIdx = 0; 
+  return true;
+}
 
-  // Initialization finished message
-  showInitFinishedMessage();
 
-  // Given enought time to print the message of initialization finished
-  while ( currentStep <= flightInitialStep + N + 2 )
+void RecoverySystem::setFlightParameter(uint8_t index, int32_t code)
+{
+  // The value must be an integer within the range of the parameter
+  FlightParameterInfo info = readFlightParameterInfo(index);
+  int32_t value;
+  if ( parser.getEntryInt(1, value) && value >= info.minimum && value <= info.maximum )
   {
-    // Read the altitude, but do not write it to the memory
-    registerAltitude(0);
+    flightParameterAt(pendingFlightParameters, info.offset) = value;
+    return;
   }
+
+  showRejectedParameter(code);
+}
+
+
+void RecoverySystem::setFlightParameters(int32_t code)
+{
+  // The message must have the code, the parameters and the CRC. It is rejected during the flight, since writing the permanent memory would block the flight task.
+  if ( isOnGround() && parser.getNumberOfEntries() == numberOfFlightParameters + 2 )
+  {
+    FlightParameters p;
+    uint16_t crc = crc16Initial;
+    bool isValid = true;
+    for (uint8_t i = 0; i < numberOfFlightParameters && isValid; ++i)
+    {
+      int32_t value;
+      isValid = ( parser.getEntryInt(i+1, value) && value >= INT16_MIN && value <= INT16_MAX );
+      flightParameterAt(p, readFlightParameterInfo(i).offset) = value;
+
+      // The CRC is calculated over the values as little-endian int16_t
+      crc = crc16Update(crc, (uint16_t) value & 0xFF);
+      crc = crc16Update(crc, (uint16_t) value >> 8);
+    }
+
+    int32_t checksum;
+    if ( isValid && parser.getEntryInt(numberOfFlightParameters+1, checksum) && checksum == crc && validateFlightParameters(p) )
+    {
+      // All the parameters are saved and applied at once
+      pendingFlightParameters = p;
+      memory.writeFlightParameters(p);
+      hasPendingFlightParameters = true;
+      clearFlight();
+      return;
+    }
+  }
+  showRejectedParameter(code);
+}
+
+
+void RecoverySystem::showRejectedParameter(int32_t code)
+{
+  // The pending parameters are kept and the rejected command is shown
+  writer.send(ocode::rejectedParameter, code);
+}
+
+
+void RecoverySystem::applyPendingFlightParameters()
+{
+  bool hasNewLandingWindow = ( pendingFlightParameters.timeForLandingDetection != flightParameters.timeForLandingDetection );
+
+  flightParameters = pendingFlightParameters;
+  hasPendingFlightParameters = false;
+
+  // The extrema of the altitude vector are rebuilt only if the window changed
+  if ( hasNewLandingWindow )
+  {
+    altitude.setExtremaWindow( flightParameters.timeForLandingDetection / (int16_t) deltaT + 1 );
+  }
+
+  showDynamicParameters(flightParameters);
+}
+
+
+void RecoverySystem::clearFlight()
+{
+  memory.erase();
+  startReport();
+
+  // The barometer, the Kalman filter and the altitude vector keep running, so only the state of the flight is reset
+  signaler.stop();
+  actuator.reload();
+  delayedWriteIdx = 0;
+  deploymentConditionSatisfied = false;
+  state = RecoverySystemState::readyToLaunch;
+
+  // The ground level drift is tracked again from the current ground altitude (see the note about ground level tracking)
+  padBaseline = newestAltitude;
 }
 
 
 void RecoverySystem::run()
 {
+  // The tasks run only after the initialization. The serial port is listened meanwhile.
+  if ( initializationState != InitializationState::finished )
+  {
+    initialize();
+    listenForMessages();
+    return;
+  }
+  scheduler.run();
+}
+
+
+void RecoverySystem::flightTask()
+{
+  // The new flight parameters are applied between time steps (see the note about hot reconfiguration in the header)
+  if ( hasPendingFlightParameters && isOnGround() )
+  {
+    applyPendingFlightParameters();
+  }
+
   // Checks for a new measurement
   bool hasNewMeasurement = false;
 
@@ -185,46 +526,152 @@ void RecoverySystem::run()
       break;
   }
 
-  // If a new measurement is available and in simulation mode, prints the current state
+  // If a new measurement is available and in simulation mode, prints the current state (telemetry, see the note about the transmission in MessageWriter.h)
   if ( hasNewMeasurement && simulationMode )
   {
-    Serial.print(F("<"));
-    Serial.print(ocode::simulatedFlightState);
-    Serial.print(F(","));
-    Serial.print((currentStep-simulationInitialStep)*deltaT);
-    Serial.print(F(","));
-    Serial.print((int32_t)(10.0*altitude[N]));
-    Serial.print(F(","));
-    Serial.print((int32_t)(10.0*currentSpeed));
-    Serial.print(F(","));
-    Serial.print((int32_t)(10.0*currentAcceleration));
-    switch (state)
-    {
+    PROFILE_STAGE(ProfilerStage::simulationState);
+
+    writer.start(ocode::simulatedFlightState, MessageWriter::Priority::low);
+    writer.add((currentStep-simulationInitialStep)*deltaT);
+    writer.add((int32_t)(10.0*(newestAltitude-padBaseline)));
+    writer.add((int32_t)(10.0*currentSpeed));
+    writer.add((int32_t)(10.0*currentAcceleration));
+    writer.add(getStateCode());
+    writer.end();
+  }
+
+  if ( hasNewMeasurement && telemetryDecimation > 0 )
+  {
+    sampleTelemetry();
+  }
+}
+
+
+void RecoverySystem::sampleTelemetry()
+{
+  if ( telemetryCountdown > 1 )
+  {
+    telemetryCountdown--;
+    return;
+  }
+  telemetryCountdown = telemetryDecimation;
+
+  // Only a copy is made here. The sample is encoded by the telemetry task (see the note about the telemetry in the header).
+  telemetrySample.step = (uint16_t) currentStep;
+  telemetrySample.altitude = newestAltitude-padBaseline;
+  telemetrySample.speed = currentSpeed;
+  telemetrySample.acceleration = currentAcceleration;
+  telemetrySample.state = getStateCode();
+  telemetrySample.eventFlags = liftoffCondition | fallCondition << 1 | apogeeCondition << 2 
+    | parachuteDeploymentCondition << 3 | landingCondition << 4;
+  hasTelemetrySample = true;
+}
+
+
+void RecoverySystem::telemetryTask()
+{
+  if ( ! hasTelemetrySample ) return;
+  hasTelemetrySample = false;
+
+  // The absent fields are skipped by the writer (see the type m in MessageWriter.h)
+  writer.start(ocode::telemetry, MessageWriter::Priority::low);
+  writer.add(telemetryFields);
+  if ( telemetryFields & 0x01 ) writer.add(telemetrySample.step);
+  if ( telemetryFields & 0x02 ) writer.add((int32_t)(10.0*telemetrySample.altitude)); // m to dm
+  if ( telemetryFields & 0x04 ) writer.add((int16_t)(10.0*telemetrySample.speed)); // m/s to dm/s
+  if ( telemetryFields & 0x08 ) writer.add((int16_t)(10.0*telemetrySample.acceleration)); // m/s2 to dm/s2
+  if ( telemetryFields & 0x10 ) writer.add(telemetrySample.state);
+  if ( telemetryFields & 0x20 ) writer.add(telemetrySample.eventFlags);
+  writer.end();
+}
+
+
+void RecoverySystem::setTelemetry(int32_t code)
+{
+  int32_t decimation;
+  int32_t fields = telemetryAllFields;
+
+  if ( ! parser.getEntryInt(1, decimation) || decimation < 0 || decimation > UINT8_MAX ||
+       ( parser.getEntryStatus(2) != MessageParser::EntryStatus::missing && 
+         ( ! parser.getEntryInt(2, fields) || fields < 0 || fields > telemetryAllFields ) ) )
+  {
+    showRejectedParameter(code);
+    return;
+  }
+
+  telemetryDecimation = (uint8_t) decimation;
+  telemetryFields = (uint8_t) fields;
+  telemetryCountdown = 0;
+  hasTelemetrySample = false;
+
+  writer.start(ocode::telemetrySettings);
+  writer.add(telemetryDecimation);
+  writer.add(telemetryFields);
+  writer.end();
+}
+
+
+void RecoverySystem::loggingTask()
+{
+  // The altitudes go first, since their queue is limited. The timing of a deployment is written in the spare runs.
+  if ( ! memory.writeQueuedAltitude() )
+  {
+    memory.writeQueuedTiming();
+  }
+}
+
+
+void RecoverySystem::userInterfaceTask()
+{
+  switch (state)
+  {
     case RecoverySystemState::readyToLaunch:
-      Serial.println(F(",R>"));
+    {
+      // Showing recovery system is ready to launch
+      showReadyToLaunchStatus();
       break;
+    }
     case RecoverySystemState::flying:
-      Serial.println(F(",F>"));
-      break;
-    case RecoverySystemState::drogueChuteActive:
-      Serial.println(F(",D>"));
-      break;
-    case RecoverySystemState::parachuteActive:
-      Serial.println(F(",P>"));
+    {
+      // Shows to user the flying status
+      showFlyingStatus();
       break;
+    }
     case RecoverySystemState::recovered:
-      Serial.println(F(",L>"));
+    {
+      // Showing the apogee, if requested
+      signaler.update();
+
+      // Reading button
+      switch (button.getState())
+      {
+
+        case ButtonState::pressedAndReleased:
+          blinkApogee(memory);
+          startReport();
+          break;
+
+        case ButtonState::longPressed:
+          // Erasing memory and getting ready to launch again
+          clearFlight();
+
+          break;
+
+        default:;
+
+      };
       break;
+    }
     default:
       break;
-    }
   }
-  listenForMessages();
 }
 
 
 void RecoverySystem::readyToLaunchRun()
 {
+  PROFILE_STAGE(ProfilerStage::stateRun);
+
   /*
 
            Scanning for liftoff
@@ -234,22 +681,18 @@ void RecoverySystem::readyToLaunchRun()
   if ( liftoffCondition > 0 ) {
     changeStateToFlying();    
   }
-  else
-  {
-    // Showing recovery system is ready to launch
-    showReadyToLaunchStatus();
-  }
 }
 
 
 void RecoverySystem::flyingRun()
 {
-  // Shows to user the flying status
-  showFlyingStatus();
+  PROFILE_STAGE(ProfilerStage::stateRun);
 
   // If rocket is falling, activates drogue chute and changes recovery system's state
   if ( ( apogeeCondition + fallCondition ) > 0 )
   {
+    uint32_t transitionTime = micros();
+
     // Preparing actuator for drogue deployment
     actuator.reload();
 
@@ -258,6 +701,7 @@ void RecoverySystem::flyingRun()
 
     // Recording the drogue activation event
     memory.writeEvent('D', (uint16_t)(currentStep-flightInitialStep));
+    startDeploymentTiming('D', transitionTime);
 
     // Changing recovery system's state
     state = RecoverySystemState::drogueChuteActive;
@@ -267,12 +711,15 @@ void RecoverySystem::flyingRun()
 
 void RecoverySystem::drogueChuteActiveRun()
 {
+  PROFILE_STAGE(ProfilerStage::stateRun);
+
   // Asks the actuator to deploy the drogue parachute.
   // After finishing one deployment cycle (turning on and off the drogue pin), the
   // actuator evaluates the stop condition, i.e., the parachute deployment condition OR
   // the number of deployment attempts. 
   bool actuatorFinished = actuator.deployDrogueChute( ( parachuteDeploymentCondition > 0 ) ||
                                                ( actuator.deployCounter >= flightParameters.maxNumberOfDeploymentAttempts ) );
+  updateDeploymentTiming('D');
 
   // If the parachute activation condition is true AND the actuator finished the deployment cycle, 
   // activates parachute and changes the state of the recovery system.
@@ -282,6 +729,8 @@ void RecoverySystem::drogueChuteActiveRun()
   // changes the state to the next one (parachuteActive).
   if ( ( actuatorFinished && ( parachuteDeploymentCondition > 0 ) ) || ( actuatorFinished && ( landingCondition > 0 ) ) )
   {
+    uint32_t transitionTime = micros();
+
     // Reloads the actuator (restarts the deploy counter etc...)
     actuator.reload();
 
@@ -290,6 +739,7 @@ void RecoverySystem::drogueChuteActiveRun()
 
     // Writing parachute activation event to memory 
     memory.writeEvent('P', (uint16_t)(currentStep-flightInitialStep));
+    startDeploymentTiming('P', transitionTime);
 
     // Changing recovery system's state
     state = RecoverySystemState::parachuteActive;
@@ -300,11 +750,14 @@ void RecoverySystem::drogueChuteActiveRun()
 
 void RecoverySystem::parachuteActiveRun()
 {
+  PROFILE_STAGE(ProfilerStage::stateRun);
+
   // Asks the actuator to deploy the main parachute.
   // After finishing one deployment cycle (turning on and off the parachute pin), the
   // actuator evaluates the stop condition, i.e., the number of deployment attempts.
   // If the condition is not satisfied, another deployment cycle is started. 
   actuator.deployParachute( actuator.deployCounter >= flightParameters.maxNumberOfDeploymentAttempts );
+  updateDeploymentTiming('P');
 
   // If rocket is recovered, changes recovery system's state
   if ( landingCondition > 0 )
@@ -323,6 +776,8 @@ void RecoverySystem::parachuteActiveRun()
 
 void RecoverySystem::recoveredRun()
 {
+  PROFILE_STAGE(ProfilerStage::stateRun);
+
   // If flying, stores data to memory and changes recovery system's state.
   // This condition should not occur in a regular flight. But, if the altimeter resets
   // during the flight, and there is some data stored, the initial state will be 'recovered'.
@@ -338,35 +793,37 @@ void RecoverySystem::recoveredRun()
     // Changing state
     changeStateToFlying();   
   }
-  else
-  {
-    // Reading button
-    switch (button.getState())
-    {
-
-      case ButtonState::pressedAndReleased:
-        blinkApogee(memory);
-        showReport();
-        break;
-
-      case ButtonState::longPressed:
-        // Erasing memory
-        memory.erase();
-        showReport();
-        
-        // Restarting recovery system
-        begin(false);
-
-        break;
+}
 
-      default:;
+void RecoverySystem::startDeploymentTiming(const char& c, uint32_t transitionTime)
+{
+  deploymentTiming = DeploymentTiming();
+  deploymentTiming.conditionToTransition = transitionTime - deploymentConditionTime;
+  deploymentTiming.conditionToPinHigh = actuator.getFirstActivationTime() - deploymentConditionTime;
+  recordedPulses = 0;
+  memory.queueDeploymentTiming(c, deploymentTiming);
+
+  // Waiting for the condition of the next deployment
+  deploymentConditionSatisfied = false;
+}
 
-    };
+void RecoverySystem::updateDeploymentTiming(const char& c)
+{
+  // The memory is written only when a pulse is finished
+  if ( actuator.getNumberOfPulses() != recordedPulses )
+  {
+    recordedPulses = actuator.getNumberOfPulses();
+    deploymentTiming.minimumPulseWidth = actuator.getMinimumPulseWidth();
+    deploymentTiming.maximumPulseWidth = actuator.getMaximumPulseWidth();
+    memory.queueDeploymentTiming(c, deploymentTiming);
   }
 }
 
-float RecoverySystem::getAltitude()
+float RecoverySystem::getAltitude(bool& isFresh)
 {
+    // Simulated altitudes are always new
+    isFresh = true;
+
     if ( simulationMode )
     {
       /* 
@@ -374,76 +831,134 @@ float RecoverySystem::getAltitude()
         waits for the response
       */
       waitingForSimulatedAltitude = true;
-
-      Serial.print(F("<"));
-      Serial.print(ocode::requestSimulatedAltitude);
-      Serial.print(F(","));
-      Serial.print((currentStep-simulationInitialStep)*deltaT);
-      //Serial.print((int32_t)currentTime-(int32_t)(simulationInitialStep*deltaT));
-      //Serial.print(millis());
-      Serial.println(F(">"));
+      requestSimulatedAltitude();
       while ( waitingForSimulatedAltitude )
       {
         listenForMessages();
       }
-      // If the code of the message is 7, reads the simulated altitude
-      if ( parser.getEntryInt(0) == 7 )
+      // If the code of the message is 7, returns the simulated altitude
+      int32_t code;
+      if ( parser.getEntryInt(0, code) && code == icode::setSimulatedFlightAltitude )
       {
         // Converting cm to m
-        return 0.01 * parser.getEntryFloat(1);
+        return 0.01 * simulatedAltitude;
       }
     }
-  return barometer.getAltitude();
+    float currentAltitude = barometer.getAltitude();
+    isFresh = barometer.isFresh();
+    return currentAltitude;
+}
+
+void RecoverySystem::requestSimulatedAltitude()
+{
+  writer.send(ocode::requestSimulatedAltitude, (currentSubStep-simulationInitialStep*oversampling)*subDeltaT);
+}
+
+bool RecoverySystem::acquireAltitude(float& currentAltitude, bool& isFresh)
+{
+  // Readings triggered by the timer (see Sampler.h)
+  if ( sampler.isRunning() )
+  {
+    if ( ! sampler.pop(currentAltitude, isFresh, currentSampleTime) ) return false;
+
+    currentSubStep++;
+    return true;
+  }
+
+  // Readings polled by the main loop
+  if ( millis() > ((uint32_t) (currentSubStep * subDeltaT)) )
+  {
+    currentSubStep++;
+    currentSampleTime = micros();
+    currentAltitude = getAltitude(isFresh);
+    return true;
+  }
+  return false;
 }
 
 bool RecoverySystem::registerAltitude(const uint8_t& scaler)
 {
+  PROFILE_STAGE(ProfilerStage::registerAltitude);
+
   static uint16_t counter = 0;
-  uint32_t currentTime = millis();
   bool hasNewMeasurement = false;
 
-  if ( currentTime > ((uint32_t) (currentStep * deltaT)))
+  // Reading the current altitude
+  bool isFresh;
+  float currentAltitude;
+
+  if ( acquireAltitude(currentAltitude, isFresh) )
   {
-    currentStep++;
-    hasNewMeasurement = true;
 
-    /*
-      Delayed altitude vector recording (see the note about altitude vector delayed record in the header)
-    */ 
-    if ( scaler > 0 ) 
+    // Updating the Kalman filter at the sampling rate (stale readings only propagate the filter)
+    // and accumulating the readings of the current time step (see the note about high-rate acquisition in the header)
+    if ( isFresh )
     {
-      if ( delayedWriteIdx < N ) 
-      {
-        memory.writeAltitude(delayedWriteIdx, altitude[0]);
-        delayedWriteIdx++;
-      }
+      PROFILE_STAGE(ProfilerStage::kalmanProcess);
+      kalmanFilter.process(currentAltitude);
+      decimatorSum += currentAltitude;
+      decimatorFreshCount++;
     }
-
-    // Shifting the altitude vector and taking another measurement
-    for (int i = 0; i < N; i++)
+    else
     {
-      altitude[i] = altitude[i + 1];
+      kalmanFilter.predict();
     }
+    decimatorCount++;
 
-    // Reading the current altitude
-    altitude[N] = getAltitude();
+    if ( decimatorCount == oversampling )
+    {
+      currentStep++;
+      hasNewMeasurement = true;
 
-    // Updating the Kalman filter
-    kalmanFilter.process(altitude[N]);
+      /*
+        Delayed altitude vector recording (see the note about altitude vector delayed record in the header)
+      */ 
+      if ( scaler > 0 ) 
+      {
+        if ( delayedWriteIdx < N ) 
+        {
+          // These altitudes precede the liftoff detection, so they are far below the saturation of the altitude history
+          memory.queueAltitude(delayedWriteIdx, altitude[0]-padBaseline);
+          delayedWriteIdx++;
+        }
+      }
 
-    if ( scaler > 0 ) 
-    {
-      counter++;
-      if ( counter == scaler )
+      // Discarding the oldest element of the altitude vector and storing the decimated altitude (the mean of the fresh readings).
+      // A stale reading repeats the last fresh one, so it is used if no fresh reading is available.
+      newestAltitude = ( decimatorFreshCount > 0 ? decimatorSum / decimatorFreshCount : currentAltitude );
+      altitude.push(newestAltitude);
+
+      // The altitude history is limited to about 3.3 km (see AltitudeHistory.h). Only the landing detection is affected,
+      // since the log and the other events use the newest altitude, which is not saturated.
+      if ( scaler > 0 && altitude.isNewestSaturated() )
+      {
+        memory.writeErrorLog(error::AltitudeHistorySaturation);
+      }
+
+      decimatorSum = 0.0;
+      decimatorCount = 0;
+      decimatorFreshCount = 0;
+
+      // Tracking the ground level drift (see the note about ground level tracking in the header)
+      if ( state == RecoverySystemState::readyToLaunch )
+      {
+        padBaseline += padBaselineWeight * ( altitude[0] - padBaseline );
+      }
+
+      if ( scaler > 0 ) 
+      {
+        counter++;
+        if ( counter == scaler )
+        {
+          memory.queueAppendAltitude(newestAltitude-padBaseline);
+          counter = 0;
+        }
+      }
+      else
       {
-        memory.appendAltitude(altitude[N]);
         counter = 0;
       }
     }
-    else
-    {
-      counter = 0;
-    }
     checkFlyEvents();
   }
   return hasNewMeasurement;
@@ -452,26 +967,21 @@ bool RecoverySystem::registerAltitude(const uint8_t& scaler)
 
 void RecoverySystem::changeStateToFlying()
 {
-    // Storing data to memory using the corrected altitude
-    //float newBaseline = altitude[0];
+    // Stopping any number being shown, since the led and the buzzer show the flying status
+    signaler.stop();
 
-    // Setting barometer new baseline
-    //barometer.setBaseline(newBaseline);
     /* 
-      Why resetting the barometer height baseline? If altimeter stays switched on for a long time, environment pressure
-      and temperature may change and, hence, change local baseline height. To avoid this problem, it is necessary to 
-      reset the barometer height baseline when liftoff is detected.
+      The ground level drift tracked while ready to launch is frozen from now on and subtracted 
+      from the altitudes written to the memory (see the note about ground level tracking in the header).
+      The ground level is written by the logging task, since writing it takes about 13 ms.
     */
-    //for (int i = 0; i <= N; i++) 
-    //{
-    //  altitude[i] = altitude[i]-newBaseline;
-    //}
+    memory.queueGroundLevel(padBaseline + ( simulationMode ? 0.0 : barometer.getBaseline() ));
 
     /*
       Delayed altitude vector recording (see the note about altitude vector delayed record in the header)
     */ 
     delayedWriteIdx = 0;
-    memory.writeAltitude(N,altitude[N]);
+    memory.queueAltitude(N,newestAltitude-padBaseline);
 
     // Reloads the actuator
     actuator.reload();
@@ -534,136 +1044,121 @@ void RecoverySystem::checkFlyEvents()
     apogeeCondition  = (  currentSpeed < flightParameters.speedForApogeeDetection ? 1 : 0 );
     
     // Checking the parachute deployment condition
-    parachuteDeploymentCondition = ( altitude[N] <= flightParameters.parachuteDeploymentAltitude ? 1 : 0 );
+    parachuteDeploymentCondition = ( newestAltitude-padBaseline <= flightParameters.parachuteDeploymentAltitude ? 1 : 0 );
 
     // Checking the landing condition
     if ( liftoffCondition || fallCondition )
     { 
       landingCondition = 0;
     }
+    else if ( altitude.isWindowSaturated() )
+    {
+      // A saturated altitude does not show the real displacement
+      landingCondition = 0;
+    }
     else{
-      float ymin=1E5, ymax=-1E5;
-      for (uint8_t i = 0; i < N+1; ++i)
-      {
-          if ( altitude[i] < ymin ) ymin = altitude[i];
-          if ( altitude[i] > ymax ) ymax = altitude[i];
-      }
-      landingCondition = ( ymax-ymin < flightParameters.displacementForLandingDetection ? 1 : 0 );
+      // The minimum and the maximum of the window are kept by the altitude history (O(1) per time step)
+      landingCondition = ( altitude.getMaximum()-altitude.getMinimum() < flightParameters.displacementForLandingDetection ? 1 : 0 );
+    }
+
+    // Registering the instant of the first reading that satisfied the condition of the next deployment
+    bool deploymentCondition = ( state == RecoverySystemState::flying && ( apogeeCondition + fallCondition ) > 0 ) ||
+      ( state == RecoverySystemState::drogueChuteActive && ( parachuteDeploymentCondition + landingCondition ) > 0 );
+    if ( deploymentCondition && ! deploymentConditionSatisfied )
+    {
+      deploymentConditionTime = currentSampleTime;
     }
+    deploymentConditionSatisfied = deploymentCondition;
 };
 
 void RecoverySystem::showStaticParameters()
 {
-  Serial.print(F("<"));
-  Serial.print(ocode::firmwareVersion);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::softwareVersion);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::actuatorDischargeTime);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::actuatorDischargeTime);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::capacitorRechargeTime);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::capacitorRechargeTime);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::N);
-  Serial.print(F(","));
-  Serial.print(N);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::deltaT);
-  Serial.print(F(","));
-  Serial.print(deltaT);
-  Serial.println(F(">"));
-
-  // Kalman filter parameters
-  Serial.print(F("<"));
-  Serial.print(ocode::kfStdExp);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::kfStdExp);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::kfStdModSub);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::kfStdModSub);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::kfStdModTra);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::kfStdModTra);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::kfDadt_ref);
-  Serial.print(F(","));
-  Serial.print(ParametersStatic::kfdadt_ref);
-  Serial.println(F(">"));
+  writer.send(ocode::firmwareVersion, ParametersStatic::softwareVersion);
+  writer.send(ocode::actuatorDischargeTime, ParametersStatic::actuatorDischargeTime);
+  writer.send(ocode::capacitorRechargeTime, ParametersStatic::capacitorRechargeTime);
+  writer.send(ocode::N, N);
+  writer.send(ocode::deltaT, deltaT);
+  writer.send(ocode::acquisitionOversampling, oversampling);
+
+  // Kalman filter parameters (fixed-point with 2 decimals, converted at compile time)
+  static constexpr int32_t kfStdExp    {toFixed(ParametersStatic::kfStdExp, 2)};
+  static constexpr int32_t kfStdModSub {toFixed(ParametersStatic::kfStdModSub, 2)};
+  static constexpr int32_t kfStdModTra {toFixed(ParametersStatic::kfStdModTra, 2)};
+  static constexpr int32_t kfDadt_ref  {toFixed(ParametersStatic::kfdadt_ref, 2)};
+  writer.send(ocode::kfStdExp, kfStdExp);
+  writer.send(ocode::kfStdModSub, kfStdModSub);
+  writer.send(ocode::kfStdModTra, kfStdModTra);
+  writer.send(ocode::kfDadt_ref, kfDadt_ref);
 }
 
 void RecoverySystem::showDynamicParameters(const FlightParameters& p)
 {
-  Serial.print(F("<"));
-  Serial.print(ocode::simulatedMode);
-  Serial.print(F(","));
-  Serial.print((simulationMode?1:0));
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::speedForLiftoffDetection);
-  Serial.print(F(","));
-  Serial.print(p.speedForLiftoffDetection);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::speedForFallDetection);
-  Serial.print(F(","));
-  Serial.print(p.speedForFallDetection);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::speedForApogeeDetection);
-  Serial.print(F(","));
-  Serial.print(p.speedForApogeeDetection);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::parachuteDeploymentAltitude);
-  Serial.print(F(","));
-  Serial.print(p.parachuteDeploymentAltitude);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::displacementForLandingDetection);
-  Serial.print(F(","));
-  Serial.print(p.displacementForLandingDetection);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::maxNumberOfDeploymentAttempts);
-  Serial.print(F(","));
-  Serial.print(p.maxNumberOfDeploymentAttempts);
-  Serial.println(F(">"));
-  Serial.print(F("<"));
-  Serial.print(ocode::timeStepScaler);
-  Serial.print(F(","));
-  Serial.print(p.timeStepScaler);
-  Serial.println(F(">"));
+  writer.send(ocode::simulatedMode, (simulationMode?1:0));
+
+  for (uint8_t i = 0; i < numberOfFlightParameters; ++i)
+  {
+    FlightParameterInfo info = readFlightParameterInfo(i);
+    writer.send(info.ocode, flightParameterAt(p, info.offset));
+  }
 }
 
+void RecoverySystem::showFlightParameterTable()
+{
+  for (uint8_t i = 0; i < numberOfFlightParameters; ++i)
+  {
+    FlightParameterInfo info = readFlightParameterInfo(i);
+    writer.start(ocode::flightParameterInfo);
+    writer.add(info.icode);
+    writer.add(info.ocode);
+    writer.add(info.defaultValue);
+    writer.add(info.minimum);
+    writer.add(info.maximum);
+    writer.add((const __FlashStringHelper*) info.units);
+    writer.end();
+  }
+}
+
+char RecoverySystem::getStateCode()
+{
+  switch (state)
+  {
+    case RecoverySystemState::readyToLaunch:     return 'R';
+    case RecoverySystemState::flying:            return 'F';
+    case RecoverySystemState::drogueChuteActive: return 'D';
+    case RecoverySystemState::parachuteActive:   return 'P';
+    case RecoverySystemState::recovered:         return 'L';
+    default:                                     return '?';
+  }
+}
+
+
 void RecoverySystem::showInitMessage(const FlightParameters& flightParameters)
 {
   tone(ParametersStatic::pinBuzzer, 4000, 250);
-  Serial.println(F("<"));
-  Serial.println(ocode::startedInitialization);
-  Serial.println(F(">"));
+  writer.send(ocode::startedInitialization);
   showStaticParameters();
   showDynamicParameters(flightParameters);
+  writer.send(ocode::freeMemory, getFreeMemory());
+}
+
+
+int RecoverySystem::getFreeMemory()
+{
+#if defined(__AVR__)
+  // Distance between the top of the stack and the top of the heap
+  extern int __heap_start, *__brkval;
+  int top;
+  return (int) &top - ( __brkval == 0 ? (int) &__heap_start : (int) __brkval );
+#else
+  return 0;
+#endif
 }
 
 
 void RecoverySystem::showInitFinishedMessage()
 {
   tone(ParametersStatic::pinBuzzer, 4000, 100);
-  Serial.println(F("<"));
-  Serial.println(ocode::finishedInitialization);
-  Serial.println(F(">"));
+  writer.send(ocode::finishedInitialization);
 }
 
 
@@ -708,165 +1203,366 @@ void RecoverySystem::showFlyingStatus()
 
 void RecoverySystem::blinkApogee(Memory& memory)
 {
-  int          thousands;
-  int           hundreds;
-  int             dozens;
-  int              units;
-  unsigned int   iHeight;
-  float          fHeight;
+  // The digits are shown by the signaler in the user interface task (see Signaler.h)
+  signaler.stop();
+  signaler.queueNumber((uint16_t)max(memory.readApogee(), 0.0f));
+}
 
-  fHeight = memory.readApogee();
+void RecoverySystem::showInvalidEntry(uint8_t entryNumber)
+{
+  writer.start(ocode::invalidEntry);
+  writer.add(entryNumber);
+  writer.add((uint8_t) parser.getEntryStatus(entryNumber));
+  writer.end();
+}
 
-  iHeight   = (int)fHeight;
-  thousands = iHeight / 1000;
-  hundreds  = iHeight % 1000;
-  hundreds  = hundreds / 100;
-  dozens    = iHeight % 100;
-  dozens    = dozens / 10;
-  units     = iHeight % 10;
 
-  if (fHeight >= 1000) blinkNumber(thousands);
+void RecoverySystem::showErrorLog()
+{
+  // The errors in the log are listed by the writer (see the error table in ParametersStatic.h)
+  writer.send(ocode::errorLog, memory.readErrorLog());
+}
+
+
+// Records of the report: start, error log, flight events, ground level, deployment timings, flight path and end
+static constexpr uint16_t reportFirstPathRecord {9};
 
-  if (fHeight >= 100)  blinkNumber(hundreds);
+void RecoverySystem::startReport()
+{
+  // Writing the altitudes still queued to the memory
+  memory.flushQueue();
+
+  uint16_t numberOfSlots = memory.getNumberOfSlotsWritten();
 
-  if (fHeight >= 10)   blinkNumber(dozens);
+  // Slot up to which data is written with higher frequency 
+  reportHfSlot = min(memory.readEvent('D'), numberOfSlots);
 
-  blinkNumber(units);
+  // Without altitudes, only the start, the error log and the end are shown
+  reportNumberOfRecords = ( numberOfSlots > 0 ? reportFirstPathRecord + numberOfSlots + 1 : 3 );
+  reportNextRecord = 0;
 }
 
-void RecoverySystem::showErrorLog()
+
+void RecoverySystem::cancelReport()
+{
+  showReportProgress();
+  reportNumberOfRecords = 0;
+  reportNextRecord = 0;
+}
+
+
+void RecoverySystem::showReportProgress()
+{
+  writer.start(ocode::reportProgress);
+  writer.add(reportNextRecord);
+  writer.add(reportNumberOfRecords);
+  writer.end();
+}
+
+
+void RecoverySystem::reportTask()
+{
+  if ( reportNumberOfRecords == 0 ) return;
+
+  // The memory is written during the flight, so the report is sent only on the ground
+  if ( ! isOnGround() )
+  {
+    cancelReport();
+    return;
+  }
+
+  for (uint8_t i = 0; i < reportRecordsPerRun && reportNextRecord < reportNumberOfRecords; ++i)
+  {
+    // Sending is postponed instead of waiting for room in the transmit buffer
+    if ( Serial.availableForWrite() < reportMinimumTxSpace ) break;
+
+    showReportRecord(reportNextRecord++);
+  }
+
+  if ( reportNextRecord == reportNumberOfRecords )
+  {
+    reportNumberOfRecords = 0;
+    reportNextRecord = 0;
+  }
+}
+
+
+void RecoverySystem::showReportRecord(uint16_t i)
 {
-  Serial.print(F("<"));
-  Serial.print(ocode::errorLog);
-  Serial.print(F(","));
-  uint16_t errorLog = memory.readErrorLog();
-  if ( errorLog > 0 ){
-    for (uint8_t i = 0; i < 16; ++i)
+  PROFILE_STAGE(ProfilerStage::reportRecord);
+
+  if ( i == 0 )
+  {
+    writer.send(ocode::stardedSendingMemoryReport);
+  }
+  else if ( i == 1 )
+  {
+    showErrorLog();
+  }
+  else if ( i + 1 == reportNumberOfRecords )
+  {
+    writer.send(ocode::finishedSendingMemoryReport);
+  }
+  else if ( i < reportFirstPathRecord )
+  {
+    // Flight events
+    switch (i)
     {
-      /* 
-        If the error is in the log, print it. See the error encode in the ErrorTable.h file.
-      */
-      if ( (errorLog & 2) == 2 )
+      case 2: writer.send(ocode::liftoffEvent,   ((int32_t)deltaT)*memory.readEvent('F')); break;
+      case 3: writer.send(ocode::drogueEvent,    ((int32_t)deltaT)*memory.readEvent('D')); break;
+      case 4: writer.send(ocode::parachuteEvent, ((int32_t)deltaT)*memory.readEvent('P')); break;
+      case 5: writer.send(ocode::landedEvent,    ((int32_t)deltaT)*memory.readEvent('L')); break;
+      case 6: writer.send(ocode::groundLevel, (int32_t)(10.0*memory.readGroundLevel())); break; // m to dm
+      default:
       {
-        Serial.print(i+1);
-        Serial.print(F(";"));
+        // Deployment timing (microseconds)
+        DeploymentTiming timing = memory.readDeploymentTiming( i == 7 ? 'D' : 'P' );
+        writer.start(ocode::deploymentTiming);
+        writer.add( i == 7 ? ocode::drogueEvent : ocode::parachuteEvent );
+        writer.add(timing.conditionToTransition);
+        writer.add(timing.conditionToPinHigh);
+        writer.add(timing.minimumPulseWidth);
+        writer.add(timing.maximumPulseWidth);
+        writer.end();
+        break;
       }
-      errorLog = errorLog >> 1;
     }
   }
   else
   {
-    Serial.print(F("0"));
+    // Flight path
+    uint16_t slot = i - reportFirstPathRecord;
+    int32_t t;
+
+    if ( slot > reportHfSlot )
+    {
+      t = (int32_t)(deltaT) * (int32_t)(flightParameters.timeStepScaler) * (slot-reportHfSlot) + (int32_t)(deltaT) * reportHfSlot;
+    }
+    else
+    {
+      t = (int32_t)(deltaT) * slot;
+    }
+
+    writer.start(ocode::flightPath);
+    writer.add(t);
+    writer.add(memory.readAltitudeDecimeters(slot));
+    writer.end();
   }
-  Serial.println(F(">"));
 }
 
 
-void RecoverySystem::showReport()
+void RecoverySystem::showLogInfo()
 {
-  Serial.print(F("<"));
-  Serial.print(ocode::stardedSendingMemoryReport);
-  Serial.print(F(">"));
+  // Writing the altitudes still queued to the memory
+  memory.flushQueue();
+
+  writer.start(ocode::logInfo);
+  writer.add(memory.getLogSize());
+  writer.add(ParametersStatic::logBlockSize);
+  writer.add(memory.readLogCrc());
+  writer.add(deltaT);
+  writer.add(flightParameters.timeStepScaler);
+  writer.add(memory.readEvent('F'));
+  writer.add(memory.readEvent('D'));
+  writer.add(memory.readEvent('P'));
+  writer.add(memory.readEvent('L'));
+  writer.end();
+}
 
-  showErrorLog();
- 
-  // Slot up to which data is written with higher frequency 
-  uint16_t hfSlot = min(memory.readEvent('D'), memory.getNumberOfSlotsWritten());
-
-  int32_t landingInstant = ((int32_t)deltaT)*memory.readEvent('L');
-
-  // Flight events
-  if ( memory.getNumberOfSlotsWritten() > 0 ){
-    Serial.print(F("<"));
-    Serial.print(ocode::liftoffEvent);
-    Serial.print(F(","));
-    Serial.print(((int32_t)deltaT)*memory.readEvent('F'));
-    Serial.println(F(">"));
-    Serial.print(F("<"));
-    Serial.print(ocode::drogueEvent);
-    Serial.print(F(","));
-    Serial.print(((int32_t)deltaT)*memory.readEvent('D'));
-    Serial.println(F(">"));
-    Serial.print(F("<"));
-    Serial.print(ocode::parachuteEvent);
-    Serial.print(F(","));
-    Serial.print(((int32_t)deltaT)*memory.readEvent('P'));
-    Serial.println(F(">"));
-    Serial.print(F("<"));
-    Serial.print(ocode::landedEvent);
-    Serial.print(F(","));
-    Serial.print(landingInstant);
-    Serial.println(F(">"));
-  
-    int32_t t0 = deltaT * hfSlot;
-    int32_t t;
-    int32_t h;
-    
-    for ( uint16_t i = 0; i < memory.getNumberOfSlotsWritten(); ++i)
-    {
-      if ( i > hfSlot )
-      {
-        t = (int32_t)(deltaT) * (int32_t)(flightParameters.timeStepScaler) * (i-hfSlot) + t0;
-      }
-      else
-      {
-        t = i * deltaT;
-      }
 
-      h = (int32_t)(10.0*memory.readAltitude(i)); // m to dm
+void RecoverySystem::startLogDownload()
+{
+  static_assert(ParametersStatic::logBlockSize + 4 <= MSGWRITERMAXPAYLOAD, "The blocks of the log must fit the binary frames");
+
+  // Writing the altitudes still queued to the memory
+  memory.flushQueue();
+
+  int32_t offset = 0;
+  int32_t numberOfBlocks = 0;
+
+  if ( parser.getEntryStatus(1) != MessageParser::EntryStatus::missing && ( ! parser.getEntryInt(1, offset) || offset < 0 ) )
+  {
+    showInvalidEntry(1);
+    return;
+  }
+  // An offset beyond the end of the log is answered by an empty block at the end of the log
+  if ( offset > (int32_t) memory.getLogSize() ) offset = memory.getLogSize();
+
+  // Number of blocks up to the end of the log
+  int32_t blocksToEnd = ( (int32_t) memory.getLogSize() - offset + ParametersStatic::logBlockSize - 1 ) / ParametersStatic::logBlockSize;
+
+  if ( parser.getEntryStatus(2) == MessageParser::EntryStatus::missing )
+  {
+    numberOfBlocks = blocksToEnd;
+  }
+  else if ( ! parser.getEntryInt(2, numberOfBlocks) || numberOfBlocks < 1 )
+  {
+    showInvalidEntry(2);
+    return;
+  }
+
+  // At least one block is sent. The blocks requested beyond the end of the log are answered by a single empty block.
+  logNextOffset = (uint16_t) offset;
+  logRemainingBlocks = (uint16_t) max(min(numberOfBlocks, blocksToEnd + 1), (int32_t) 1);
+}
+
+
+void RecoverySystem::showNextLogBlock()
+{
+  uint8_t data[ParametersStatic::logBlockSize];
+  uint8_t n = memory.readLog(logNextOffset, data, ParametersStatic::logBlockSize);
+
+  writer.start(ocode::logBlock);
+  writer.add(logNextOffset);
+  writer.add(crc16(data, n));
+  writer.add(data, n);
+  writer.end();
+
+  // The empty block at the end of the log finishes the download
+  logNextOffset += n;
+  logRemainingBlocks = ( n == 0 ? 0 : logRemainingBlocks - 1 );
+}
+
+
+void RecoverySystem::logDownloadTask()
+{
+  if ( logRemainingBlocks == 0 ) return;
+
+  // The memory is written during the flight, so the log is sent only on the ground
+  if ( ! isOnGround() )
+  {
+    logRemainingBlocks = 0;
+    return;
+  }
+
+  // Sending is postponed instead of waiting for room in the transmit buffer. In ASCII, a block is
+  // longer than the transmit buffer, so the writer waits for the rest of a single block.
+  if ( Serial.availableForWrite() < logBlockMinimumTxSpace ) return;
+
+  showNextLogBlock();
+}
+
+
+void RecoverySystem::showBarometerBenchmark()
+{
+  static constexpr uint8_t numberOfReadings {20};
 
-      Serial.print(F("<"));
-      Serial.print(ocode::flightPath);
-      Serial.print(F(","));
-      Serial.print(t);
-      Serial.print(F(","));
-      Serial.print(h);
-      Serial.println(F(">"));
+  // The SPI bus is tested only if the barometer is wired to it. Otherwise, both I2C clocks are tested.
+  static constexpr BarometerBus buses[] {BarometerBus::i2cStandard, BarometerBus::i2cFast, BarometerBus::spi};
+
+  // The timer must not read the barometer while the bus is reconfigured
+  bool samplerWasRunning = sampler.isRunning();
+  sampler.stop();
+
+  for (uint8_t i = 0; i < sizeof(buses)/sizeof(buses[0]); ++i)
+  {
+    uint32_t readTime = barometer.measureReadTime(buses[i], numberOfReadings);
+
+    if ( readTime > 0 )
+    {
+      writer.start(ocode::barometerReadTime);
+      writer.add((uint8_t)buses[i]);
+      writer.add(readTime);
+      writer.end();
     }
+  }
 
+  if ( samplerWasRunning )
+  {
+    sampler.begin(barometer, subDeltaT);
   }
-  Serial.print(F("<"));
-  Serial.print(ocode::finishedSendingMemoryReport);
-  Serial.print(F(">"));
 }
 
 
-void RecoverySystem::blinkNumber(int n)
+void RecoverySystem::showAcquisitionStatistics()
 {
+  static constexpr uint8_t maxBarometers {ParametersStatic::maxNumberOfBarometers};
+  uint8_t health[maxBarometers];
+  float innovationVariance[maxBarometers];
+
+  // The statistics are updated by the timer interrupt (see Sampler.h), so they are copied at once.
+  // The square roots are taken afterwards, so that the interrupts are disabled only for the copy.
+  noInterrupts();
+  uint32_t numberOfReadings = barometer.getNumberOfReadings();
+  uint32_t numberOfStaleReadings = barometer.getNumberOfStaleReadings();
+  uint8_t numberOfBarometers = barometer.getNumberOfBarometers();
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
+  {
+    health[i] = barometer.getHealth(i);
+    innovationVariance[i] = barometer.getInnovationVariance(i);
+  }
+  interrupts();
 
-  int i;
+  writer.start(ocode::staleReadings);
+  writer.add(numberOfReadings);
+  writer.add(numberOfStaleReadings);
+  writer.end();
 
-  if (n == 0)
+  for (uint8_t i = 0; i < numberOfBarometers; ++i)
   {
-    digitalWrite(ParametersStatic::pinLed, LOW);
-    noTone(ParametersStatic::pinBuzzer);
-    delay(300);
-    digitalWrite(ParametersStatic::pinLed, HIGH);
-    tone(ParametersStatic::pinBuzzer, 600);
-    delay(1000);
-    digitalWrite(ParametersStatic::pinLed, LOW);
-    noTone(ParametersStatic::pinBuzzer);
+    writer.start(ocode::barometerHealth);
+    writer.add(i);
+    writer.add(health[i]);
+    writer.add((int32_t)(10.0*sqrt(innovationVariance[i]))); // Standard deviation of the innovation, m to dm
+    writer.end();
   }
 
-  for (i = 1; i <= n; i++)
+  writer.start(ocode::sampleOverruns);
+  writer.add(sampler.getNumberOfOverruns());
+  writer.add(sampler.getNumberOfMissedTicks());
+  writer.end();
+}
+
+
+void RecoverySystem::showTaskStatistics()
+{
+  for (uint8_t i = 0; i < numberOfTasks; ++i)
   {
-    digitalWrite(ParametersStatic::pinLed, LOW);
-    noTone(ParametersStatic::pinBuzzer);
-    delay(300);
-    digitalWrite(ParametersStatic::pinLed, HIGH);
-    tone(ParametersStatic::pinBuzzer, 600);
-    delay(300);
-    digitalWrite(ParametersStatic::pinLed, LOW);
-    noTone(ParametersStatic::pinBuzzer);
+    writer.start(ocode::taskStatistics);
+    writer.add(i);
+    writer.add(scheduler.getWorstCaseTime(i));
+    writer.add(scheduler.getDeadlineMisses(i));
+    writer.end();
   }
+}
 
-  delay(500);
 
-};
+void RecoverySystem::showTxStatistics()
+{
+  writer.start(ocode::txStatistics);
+  writer.add(writer.getNumberOfBytesSent());
+  writer.add(writer.getNumberOfDroppedMessages());
+  writer.add(writer.getBlockedTime());
+  writer.end();
+}
+
+
+void RecoverySystem::showStageTimings()
+{
+#ifdef RROCKET_PROFILING
+  for (uint8_t i = 0; i < Profiler::numberOfStages; ++i)
+  {
+    ProfilerStage stage = (ProfilerStage) i;
+    writer.start(ocode::stageTiming);
+    writer.add(i);
+    writer.add(profiler.getCount(stage));
+    writer.add(profiler.getMinimum(stage));
+    writer.add(profiler.getMean(stage));
+    writer.add(profiler.getMaximum(stage));
+    for (uint8_t j = 0; j < Profiler::numberOfBins; ++j)
+    {
+      writer.add(profiler.getHistogram(stage, j));
+    }
+    writer.end();
+  }
+#endif
+}
 
 
 void RecoverySystem::listenForMessages()
 {
+  PROFILE_STAGE(ProfilerStage::listenForMessages);
+
   size_t sz = Serial.available();
   for (size_t i = 0; i < sz; i++) 
   {
@@ -874,92 +1570,175 @@ void RecoverySystem::listenForMessages()
   }
   if ( parser.hasMessage() )
   {
-    switch ( parser.getEntryInt(0) )
+    // The code of the message must be an integer
+    int32_t code;
+    if ( ! parser.getEntryInt(0, code) )
+    {
+      showInvalidEntry(0);
+      return;
+    }
+
+    switch ( code )
     {
     case icode::readStaticParameters: // Shows static parameters
     {
       showStaticParameters();
       break;
     }
-    case icode::readDynamicParameters: // Shows flight parameters
+    case icode::readDynamicParameters: // Shows the pending flight parameters, i.e. the ones in use with the changes of the set commands not written yet
     {
-      showDynamicParameters(flightParameters);
+      showDynamicParameters(pendingFlightParameters);
       break;
     }
-    case icode::writeDynamicParameters: // Writes flight parameters to permanent memory
+    case icode::writeDynamicParameters: // Writes flight parameters to permanent memory and applies them (see the note about hot reconfiguration in the header)
     {
-      memory.writeFlightParameters(flightParameters);
-      memory.erase();
-      showReport();
-      begin(false);
+      // Writing the permanent memory would block the flight task
+      if ( ! isOnGround() )
+      {
+        showRejectedParameter(code);
+        break;
+      }
+      memory.writeFlightParameters(pendingFlightParameters);
+      hasPendingFlightParameters = true;
+      clearFlight();
       break;
     }
     case icode::restoreToFactoryParameters: // Clears records of the last flight and saves the parameters of the factory
     {
+      if ( ! isOnGround() )
+      {
+        showRejectedParameter(code);
+        break;
+      }
       FlightParameters p; // Creates flight parameters with default values
-      flightParameters = p;
+      pendingFlightParameters = p;
       memory.writeFlightParameters(p);
-      memory.erase();
-      showReport();
-      begin(false);
+      hasPendingFlightParameters = true;
+      clearFlight();
+      break;
+    }
+    case icode::clearFlightMemory: // Clears records of the last flight (ignored during the flight)
+    {
+      if ( isOnGround() ) clearFlight();
       break;
     }
-    case icode::clearFlightMemory: // Clears records of the last flight
+    case icode::readFlightReport: // Shows the report of the last flight in the background (see the note about the report in the header)
     {
-      memory.erase();
-      showReport();
-      begin(false);
+      startReport();
       break;
     }
-    case icode::readFlightReport: // Shows the report of the last flight
+    case icode::readReportProgress: // Shows the number of records of the report already sent and the total
     {
-      showReport();
+      showReportProgress();
+      break;
+    }
+    case icode::cancelReport: // Cancels the report and shows its progress
+    {
+      cancelReport();
       break;
     }
     case icode::setSimulationMode: // Sets the simulation mode (0=off, 1=on)
     {
-      bool simMode = ( parser.getEntryInt(1) == 1 ? true : false );
+      int32_t mode;
+      bool simMode = ( parser.getEntryInt(1, mode) && mode == 1 );
       begin(simMode);
       break;
     }
-    case icode::setSimulatedFlightAltitude: // Sets the altitude (m) for the requested instant in the simulation mode
+    case icode::setSimulatedFlightAltitude: // Sets the altitude (cm) for the requested instant in the simulation mode
     {
-      waitingForSimulatedAltitude = false;
+      // The altitude is decoded as a fixed-point number (any decimals are truncated). If it is not valid, it is requested again.
+      if ( parser.getEntryFixed(1, 0, simulatedAltitude) )
+      {
+        waitingForSimulatedAltitude = false;
+      }
+      else if ( waitingForSimulatedAltitude )
+      {
+        showInvalidEntry(1);
+        requestSimulatedAltitude();
+      }
       break;
     }
-    case icode::setSpeedForLiftoffDetection: // Sets the speed for liftoff detection (m/s)
+#define X(name, setter, setterCode, value, minimum, maximum, units) \
+    case icode::setter: /* Sets the pending flight parameter, which is applied by writeDynamicParameters (see the note about hot reconfiguration in the header) */ \
+    { \
+      setFlightParameter(flightParameter::name, code); \
+      break; \
+    }
+    RROCKET_FLIGHT_PARAMETERS(X)
+#undef X
+    case icode::readFlightParameterTable: // Shows the code, the default value, the range and the units of each flight parameter
     {
-      flightParameters.speedForLiftoffDetection = parser.getEntryInt(1);
+      showFlightParameterTable();
       break;
     }
-    case icode::setSpeedForFallDetection: // Sets the speed for fall detection (m/s)
+    case icode::readTaskStatistics: // Shows the worst-case run time (microseconds) and the deadline misses of each task
     {
-      flightParameters.speedForFallDetection = parser.getEntryInt(1);
+      showTaskStatistics();
       break;
     }
-    case icode::setSpeedForApogeeDetection: // Sets the speed for apogee detection (m/s)
+    case icode::readStageTimings: // Shows the run time statistics of the stages of the main loop (only if compiled with RROCKET_PROFILING)
     {
-      flightParameters.speedForApogeeDetection = parser.getEntryInt(1);
+      showStageTimings();
       break;
     }
-    case icode::setParachuteDeploymentAltitude: // Sets the altitude to deploy the main parachute (m)
+    case icode::setProtocol: // Sets the protocol of the output messages (0=ASCII, 1=binary, see MessageWriter.h) and confirms it in the new protocol
     {
-      flightParameters.parachuteDeploymentAltitude = parser.getEntryInt(1);
+      int32_t protocol;
+      bool isBinary = ( parser.getEntryInt(1, protocol) && protocol == 1 );
+      writer.setProtocol( isBinary ? MessageWriter::Protocol::binary : MessageWriter::Protocol::ascii );
+      writer.send(ocode::protocol, (uint8_t) writer.getProtocol());
       break;
     }
-    case icode::setDisplacementForLandingDetection: // Sets the displacement for landing detection (m)
+    case icode::setFlightParameters: // Sets, writes to permanent memory and applies all the flight parameters (see the note about hot reconfiguration in the header)
     {
-      flightParameters.displacementForLandingDetection = parser.getEntryInt(1);
+      setFlightParameters(code);
       break;
     }
-    case icode::setMaxNumberOfDeploymentAttempts: // Sets the maximum number of deployment attempts
+    case icode::readLogInfo: // Shows the size, the CRC and the time base of the log of altitudes (see the note about the log download in the header)
     {
-      flightParameters.maxNumberOfDeploymentAttempts = parser.getEntryInt(1);
+      // Writing the queued altitudes to the memory would block the flight task
+      if ( ! isOnGround() )
+      {
+        showRejectedParameter(code);
+        break;
+      }
+      showLogInfo();
+      break;
+    }
+    case icode::readLogBlocks: // Sends blocks of the log of altitudes in the background (see the note about the log download in the header)
+    {
+      if ( ! isOnGround() )
+      {
+        showRejectedParameter(code);
+        break;
+      }
+      startLogDownload();
+      break;
+    }
+    case icode::readTxStatistics: // Shows the number of bytes sent, of messages dropped and the blocked time (microseconds) of the serial port
+    {
+      showTxStatistics();
+      break;
+    }
+    case icode::setTelemetry: // Sets the decimation and the fields of the telemetry (see the note about the telemetry in the header)
+    {
+      setTelemetry(code);
+      break;
+    }
+    case icode::runBarometerBenchmark: // Shows the time to read the barometer (microseconds) through each bus
+    {
+      // The benchmark stops the timer-driven readings and reads the barometer for tens of milliseconds
+      if ( ! isOnGround() )
+      {
+        showRejectedParameter(code);
+        break;
+      }
+      showBarometerBenchmark();
       break;
     }
-    case icode::setTimeStepScaler: // Sets the scaler for adaptive deltaT
+    case icode::readAcquisitionStatistics: // Shows the number of readings and of stale readings of the barometer
     {
-      flightParameters.timeStepScaler = parser.getEntryInt(1);
+      showAcquisitionStatistics();
       break;
     }
     default:
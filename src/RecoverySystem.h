@@ -28,6 +28,11 @@
 
 #include "Arduino.h"
 #include "Barometer.h"
+#include "Sampler.h"
+#include "AltitudeHistory.h"
+#include "Scheduler.h"
+#include "MessageWriter.h"
+#include "Signaler.h"
 #include "Memory.h"
 #include "Button.h"
 #include "Actuator.h"
@@ -52,6 +57,14 @@
 
 enum class RecoverySystemState {readyToLaunch, flying, drogueChuteActive, parachuteActive, recovered};
 
+/*
+
+                                     Initialization States
+
+*/
+
+enum class InitializationState : uint8_t {barometer, actuator, warmUp, simulatedWarmUp, finished};
+
 /*
 
                                              apogee
@@ -98,12 +111,179 @@ enum class RecoverySystemState {readyToLaunch, flying, drogueChuteActive, parach
   during the flight until all elements are recorded.
 */
 
+/*
+  Note about high-rate acquisition
+  --------------------------------
+
+  The barometer may be read acquisitionOversampling times per time step deltaT (see ParametersStatic).
+  Every reading feeds the Kalman filter, so that the flight events based on the estimated speed
+  are checked at the sampling rate. The readings of a time step are decimated by a boxcar filter
+  (the average of the readings, i.e., a first order CIC filter) before being stored in the altitude
+  vector. Hence, the altitude vector and the memory are still updated once per deltaT.
+
+  Stale readings (see Barometer::isFresh) do not carry new information. They only propagate the
+  Kalman filter (prediction step) and are excluded from the average.
+*/
+
+/*
+  Note about ground level tracking
+  --------------------------------
+
+  The barometer baseline is set at boot. If the altimeter stays on the launch pad for a long time,
+  the changes of the weather drift the measured altitude of the ground. While readyToLaunch, the 
+  drift (padBaseline) is tracked by an exponential moving average of the oldest element of the 
+  altitude vector, which is N time steps older than the liftoff detection and, hence, was measured 
+  on the ground. The tracker freezes at liftoff.
+
+  The altitude vector is not rewritten. Instead, padBaseline is subtracted whenever the altitude
+  above the ground is required (memory, parachute deployment and simulation output). The ground
+  level at liftoff (barometer baseline plus padBaseline) is written to the memory.
+*/
+
+/*
+  Note about the initialization
+  -----------------------------
+
+  begin() only performs the quick initializations (memory, parameters, button, etc.). The barometer,
+  the actuator and the altitude vector are initialized by a state machine, which is advanced by run(),
+  so that the serial port is listened during the initialization:
+    - barometer, actuator: the initialization is retried every 100 ms until it succeeds;
+    - warmUp: the barometer is read as fast as possible until warmUpReadings fresh readings are 
+      taken (or maxWarmUpTime elapses). The altitude vector and the Kalman filter are seeded with
+      the mean of the readings, instead of waiting N time steps for the altitude vector to be populated;
+    - simulatedWarmUp: in the simulation mode, the altitudes are requested for each time step, so
+      the altitude vector is populated at the regular rate.
+  The time spent in the initialization is shown at the end.
+*/
+
+/*
+  Note about the task scheduler
+  -----------------------------
+
+  The main loop is divided into tasks, which are run by a cooperative scheduler (see Scheduler.h)
+  according to their priorities:
+    0. flight: reads the altitude, checks the flight events and deploys the parachutes;
+    1. logging: writes the queued altitudes to the memory (see Memory::queueAltitude);
+    2. user interface: led, buzzer and button;
+    3. serial: listens to the messages of the serial port;
+    4. telemetry: sends the last sample of the telemetry, if any (see the note about the telemetry);
+    5. report: sends the next records of the report, if one was requested (see the note about the report);
+    6. log download: sends the next block of the log, if blocks were requested (see the note about the log download).
+  Hence, the flight task never waits for more than one run of a lower priority task. The worst-case
+  run time and the deadline misses of each task may be read through the serial port.
+*/
+
+/*
+  Note about the report
+  ---------------------
+
+  The report of the last flight (see startReport) is sent in the background by the report task, so
+  that the sensing and the flight events keep running (e.g., the detection of a liftoff after a 
+  reset during the flight). The report is a sequence of records (start, error log, events, timings,
+  flight path and end) and a cursor points to the next one. Each run of the report task sends at
+  most reportRecordsPerRun records, and only while the transmit buffer of the serial port has
+  room for a record, so that sending never blocks. The messages
+    <24> shows the progress of the report <46,recordsSent,numberOfRecords> (0,0 if idle)
+    <25> cancels the report and shows its progress
+  A new request restarts the report. Since the memory is written during the flight, the report is
+  sent only on the ground and it is canceled if a flight starts.
+*/
+
+/*
+  Note about the telemetry
+  ------------------------
+
+  The state of the flight may be streamed through the serial port (e.g., by a radio) during the
+  flight. The message
+    <27,decimation,fields>
+  sends a sample every decimation time steps (0 = off) with the fields selected by the bits of
+  fields (all if missing):
+    bit 0: time step (uint16_t, currentStep)    bit 3: acceleration (dm/s2, int16_t)
+    bit 1: altitude AGL (dm, int32_t)          bit 4: state (R, F, D, P or L)
+    bit 2: speed (dm/s, int16_t)               bit 5: event flags (bit 0 liftoff, 1 fall, 
+                                                      2 apogee, 3 parachute deployment, 4 landing)
+  and it is confirmed by <49,decimation,fields>. Each sample is sent as
+    <48,fields,field1,field2,...>
+  (see the type m in the note about the message table in MessageWriter.h). The full binary frame 
+  has 18 bytes. The flight task only copies the state to the sample. The sample is encoded and sent 
+  by the telemetry task as a low priority message, which is dropped if the transmit buffer is full
+  (see the note about the transmission in MessageWriter.h). Hence, the transmission never delays 
+  the next reading by more than a run of the telemetry task. A newer sample replaces a sample not 
+  encoded yet, but a sample dropped for lack of room in the transmit buffer is lost.
+*/
+
+/*
+  Note about hot reconfiguration
+  ------------------------------
+
+  The flight parameters are changed through the serial port without reinitializing the system,
+  in three steps:
+    1. set: the set commands (<8,value> to <14,value> and <17,value>) change the pending parameters, 
+       which are validated field by field against the ranges of the parameter registry (see 
+       ParametersDynamic.h). An invalid value is rejected and the code of the command is shown;
+    2. read: <1> shows the pending parameters, i.e. the parameters in use with the changes not 
+       written yet;
+    3. write: <2> saves the pending parameters to the permanent memory and the flight task swaps
+       them with the parameters in use at the beginning of its next run, so that all the parameters
+       change at once, between two time steps. The parameters in use are shown when they change.
+  Until the write, the parameters in use do not change. During the flight, the set commands are
+  still accepted, but the commands that write the permanent memory (including the factory 
+  parameters and the message below) are rejected, since the write would block the flight task.
+  Only the landing window of the altitude vector depends on the parameters, and it is rebuilt
+  only if it changed.
+
+  The message
+    <28>
+  is answered, for each parameter of the registry, by
+    <50,icode,ocode,defaultValue,minimum,maximum,units>
+  so that the host may validate the parameters before sending them.
+
+  All the parameters may also be set, written and applied by a single message
+    <20,speedForLiftoffDetection,speedForFallDetection,speedForApogeeDetection,
+        parachuteDeploymentAltitude,displacementForLandingDetection,
+        maxNumberOfDeploymentAttempts,timeStepScaler,timeForLandingDetection,crc>
+  where crc is the CRC-16/CCITT-FALSE (see Crc16.h) of the parameters as little-endian int16_t, in
+  the order of the registry. The message is rejected as a whole if the CRC or any parameter is not valid.
+
+  Writing the parameters or clearing the memory erases the records of the last flight and gets
+  the system ready to launch again, but the barometer, the Kalman filter and the altitude vector
+  keep running. Only switching the simulation mode restarts the system, since it changes the 
+  source of the altitudes.
+*/
+
+/*
+  Note about the log download
+  ---------------------------
+
+  Besides the report (see the note about the report), the log of altitudes of the last flight may be downloaded
+  as raw blocks of the permanent memory, which is much faster in the binary protocol. The message
+    <22>
+  is answered by the log info 
+    <44,size,blockSize,crc,deltaT,timeStepScaler,liftoff,drogue,parachute,landed>
+  where size is the number of bytes of the log, crc is the CRC-16 of the whole log (see Crc16.h)
+  and the events are given in multiples of deltaT. The message
+    <23,offset,numberOfBlocks>
+  is answered by the blocks of blockSize bytes starting at the byte offset of the log
+    <45,offset,crc,data>
+  where crc is the CRC-16 of the data of the block. If numberOfBlocks is missing, the blocks are sent
+  up to the end of the log. An offset at or beyond the end of the log is answered by an empty
+  block at the end of the log. The blocks are sent in the background by the log download task, 
+  one per run and only while the transmit buffer has room for a whole binary frame, so that the
+  tasks of higher priority are not delayed. A new request restarts the download. Both messages 
+  are rejected during the flight, since they write the queued altitudes to the memory, and the 
+  download is canceled if a flight starts.
+  Each altitude occupies 2 bytes of the log (little-endian, see Memory.h), sampled every deltaT 
+  up to the drogue event and every deltaT*timeStepScaler after it. The host requests again the 
+  blocks missing or corrupted and may resume an interrupted download from any offset 
+  (see test/logdownload.py).
+*/
+
 
 class RecoverySystem
 {
   public:
 
-    //  Recovery initializer
+    //  Recovery initializer (see the note about the initialization)
     void begin(bool simulationMode);
 
     // Reads sensors and execute recovery algorithm
@@ -111,6 +291,51 @@ class RecoverySystem
 
   private:
 
+    // Advances the initialization (see the note about the initialization)
+    void initialize();
+
+    // Starts the warm-up of the altitude vector and of the Kalman filter
+    void startWarmUp();
+
+    // Initializes the Kalman filter with the initial altitude h0
+    void beginKalmanFilter(float h0);
+
+    // Initializes the tasks and shows the time spent in the initialization
+    void finishInitialization();
+
+    // Returns true if the rocket is ready to launch or recovered
+    bool isOnGround();
+
+    // Returns true if all the flight parameters are within their valid ranges
+    static bool validateFlightParameters(const FlightParameters& p);
+
+    // Sets the parameter of the given index of the registry to the value of the message, if it is valid. Otherwise, shows the code of the rejected command.
+    void setFlightParameter(uint8_t index, int32_t code);
+
+    // Sets all the flight parameters from a single message, if they and the CRC are valid (see the note about hot reconfiguration)
+    void setFlightParameters(int32_t code);
+
+    // Shows the code of a command whose parameters were rejected
+    void showRejectedParameter(int32_t code);
+
+    // Applies the pending parameters (see the note about hot reconfiguration)
+    void applyPendingFlightParameters();
+
+    // Erases the memory and gets ready to launch again, without reinitializing the sensors
+    void clearFlight();
+
+    // Starts sending the report in the background (see the note about the report)
+    void startReport();
+
+    // Cancels the report and shows its progress
+    void cancelReport();
+
+    // Shows the record i of the report (see the note about the report)
+    void showReportRecord(uint16_t i);
+
+    // Shows the number of records of the report already sent and the total
+    void showReportProgress();
+
     // The following functions define the behavior of recovery system,
     // that change dynamically in accordance to recovery system's state
     void     readyToLaunchRun();
@@ -119,11 +344,30 @@ class RecoverySystem
     void   parachuteActiveRun();
     void         recoveredRun();
 
+    // Tasks of the main loop (see the note about the task scheduler)
+    void        flightTask();
+    void       loggingTask();
+    void userInterfaceTask();
+    void     telemetryTask();
+    void        reportTask();
+    void   logDownloadTask();
+
 
     /*
-      Reads the current altitude
+      Reads the current altitude. isFresh is set to false if the
+      reading is a repetition of the previous one (stale reading).
     */
-    float getAltitude();
+    float getAltitude(bool& isFresh);
+
+    // Requests the simulated altitude of the current reading through the serial port
+    void requestSimulatedAltitude();
+
+    /*
+      Takes the next reading from the sampler queue (timer-driven readings) or, if the timer 
+      is not running, reads the barometer when the next sampling instant is reached. 
+      Advances currentSubStep and returns true if a reading is available.
+    */
+    bool acquireAltitude(float& currentAltitude, bool& isFresh);
 
     /* 
       Updates altitude vector and writes data to permanent memory
@@ -136,6 +380,15 @@ class RecoverySystem
     bool registerAltitude(const uint8_t& scaler);
 
 
+    /*
+      Queues to the memory the latencies of the deployment of the event c ('D' or 'P')
+      (see DeploymentTiming). Must be called after the first activation of the actuator.
+    */
+    void startDeploymentTiming(const char& c, uint32_t transitionTime);
+
+    // Queues to the memory the pulse widths of the deployment of the event c, if a pulse was finished
+    void updateDeploymentTiming(const char& c);
+
     // Changes the recovery system state to 'flying'.
     void changeStateToFlying(); 
 
@@ -163,9 +416,18 @@ class RecoverySystem
     // Shows the rRocket dynamic parameters
     void showDynamicParameters(const FlightParameters& p);
 
+    // Shows the registry of the flight parameters (see the note about the parameter registry in ParametersDynamic.h)
+    void showFlightParameterTable();
+
+    // Returns the character that represents the state of the recovery system (R, F, D, P or L)
+    char getStateCode();
+
     // Shows initialization messages
     void showInitMessage(const FlightParameters& flightParameters);
 
+    // Returns the number of free bytes of SRAM between the heap and the stack (0 if not available)
+    static int getFreeMemory();
+
     // Shows initialization finished message
     void showInitFinishedMessage();
 
@@ -175,17 +437,44 @@ class RecoverySystem
     // Shows to user the flying status
     void showFlyingStatus();
 
-    // Blinks apogee
+    // Blinks apogee (without blocking, see Signaler.h)
     void blinkApogee(Memory& memory);
 
     // Shows the error log
     void showErrorLog();
 
-    // Shows the report of apogee, trajectory, errors, etc
-    void showReport();
+    // Shows the status of the decoding of an invalid entry of the last message (see MessageParser::EntryStatus)
+    void showInvalidEntry(uint8_t entryNumber);
+
+    // Shows the size, the CRC and the time base of the log of altitudes (see the note about the log download)
+    void showLogInfo();
+
+    // Starts sending the blocks of the log of altitudes requested by the last message (see the note about the log download)
+    void startLogDownload();
+
+    // Shows the next block of the log download and advances its cursor
+    void showNextLogBlock();
+
+    // Shows the mean time to read the barometer through each available bus (only on the ground, since the readings of the flight stop meanwhile)
+    void showBarometerBenchmark();
+
+    // Shows the number of readings and of stale readings of the barometer, the health of each sensor and the overruns of the sampler
+    void showAcquisitionStatistics();
 
-    // Blinks a number
-    void blinkNumber(int n);
+    // Shows the worst-case run time and the deadline misses of each task
+    void showTaskStatistics();
+
+    // Shows the run time statistics of the stages of the main loop (see Profiler.h)
+    void showStageTimings();
+
+    // Shows the statistics of the transmission (see the note about the transmission in MessageWriter.h)
+    void showTxStatistics();
+
+    // Sets the decimation and the fields of the telemetry from the last message (see the note about the telemetry)
+    void setTelemetry(int32_t code);
+
+    // Copies the current state to the sample of the telemetry, if it is due
+    void sampleTelemetry();
 
     // Listen to serial
     void listenForMessages();
@@ -194,27 +483,54 @@ class RecoverySystem
 
     bool                simulationMode {false}; // If true, uses a simulated barometer (through serial port)
     bool   waitingForSimulatedAltitude {false}; // Lock used to wait for simulated altitude after a request in the simulation mode
+    int32_t             simulatedAltitude {0}; // Last simulated altitude received (cm)
     
     float                     currentSpeed {0}; // Current speed (m/s)
     float              currentAcceleration {0}; // Current acceleration (m/s2)
     int32_t                    currentStep {0}; // Current time step = int( millis()/deltaT )
+    int32_t                 currentSubStep {0}; // Current sampling step = int( millis()/subDeltaT )
     int32_t              flightInitialStep {0}; // Time step when the flight was detected
     int32_t          simulationInitialStep {0}; // Step of the simulation start
+    uint32_t             currentSampleTime {0}; // Instant of the current reading (microseconds)
     
     RecoverySystemState               state; // Current state of recovery system
+
+    // See the note about the initialization
+    InitializationState initializationState {InitializationState::barometer}; // Current state of the initialization
+    uint32_t         initializationStartTime {0}; // Instant of the call to begin() (ms)
+    uint32_t          nextInitializationTime {0}; // Instant of the next initialization attempt or of the end of the warm-up (ms)
+    bool      hasInitializationFailed {false}; // True if the last initialization attempt failed
+    float                       warmUpSum {0}; // Sum of the fresh readings of the warm-up
+    uint8_t                   warmUpCount {0}; // Number of fresh readings of the warm-up
+    static constexpr uint8_t warmUpReadings {8}; // Number of fresh readings of the warm-up
+    static constexpr uint16_t maxWarmUpTime {1000}; // Maximum duration of the warm-up (ms)
     Barometer                     barometer; // Barometer manager
+    Sampler                         sampler; // Timer-driven barometer readings
     Memory                           memory; // EEPROM Memory manager
     Button                           button; // Button for interaction with user
+    Signaler                       signaler; // Shows numbers through the led and the buzzer
     Actuator                       actuator; // Actuator for deployment of drogue and parachute
 
     static constexpr uint8_t N            {ParametersStatic::N}; // Number of time steps to calculate the flight statistics (must be a multiple of 4)
     static constexpr uint16_t deltaT {ParametersStatic::deltaT}; // Time step between measurements (ms)
 
+    static constexpr uint8_t oversampling {ParametersStatic::acquisitionOversampling}; // Number of readings per time step
+    static constexpr uint16_t subDeltaT {deltaT/oversampling}; // Time step between readings (ms)
+    static_assert(oversampling > 0 && deltaT % oversampling == 0, "deltaT must be a multiple of acquisitionOversampling");
+
     static constexpr uint8_t   halfN = N/2; // Half the number of time steps
     static constexpr uint8_t   quarN = N/4; // The fourth part of the number of time steps
-    float                 altitude[N+1] {}; // Register of the last N+1 measurements
+    AltitudeHistory<N+1, ParametersStatic::maxLandingWindow> altitude; // Register of the last measurements (altitude[0] is the oldest and altitude[N] is the newest of the last N+1)
+    float              newestAltitude {0}; // Newest decimated altitude, not saturated (m), used by the log and by the events
     // See the note about altitude vector delayed record in the header
     uint8_t            delayedWriteIdx = 0; // Index to write altitude vector to memory after liftoff
+    // See the note about high-rate acquisition in the header
+    float                decimatorSum {0}; // Sum of the fresh readings of the current time step
+    uint8_t            decimatorCount {0}; // Number of readings of the current time step
+    uint8_t       decimatorFreshCount {0}; // Number of fresh readings of the current time step
+    // See the note about ground level tracking in the header
+    float                 padBaseline {0}; // Drift of the ground level since the initialization (m)
+    static constexpr float padBaselineWeight {1E-3*deltaT/ParametersStatic::padBaselineTimeConstant}; // Weight of the new element in the moving average
 
     // Event flags (1 if condition is satisfied, 0 otherwise)
     uint8_t             liftoffCondition {0};
@@ -223,8 +539,16 @@ class RecoverySystem
     uint8_t parachuteDeploymentCondition {0};
     uint8_t             landingCondition {0};
 
-    // Flight parameters
-    FlightParameters flightParameters;
+    // Timing of the current deployment (see DeploymentTiming)
+    bool    deploymentConditionSatisfied {false}; // True if the condition of the next deployment is satisfied
+    uint32_t       deploymentConditionTime {0}; // Instant of the first reading that satisfied the condition (microseconds)
+    DeploymentTiming          deploymentTiming; // Latencies and pulse widths of the current deployment
+    uint8_t                 recordedPulses {0}; // Number of pulses written to the memory
+
+    // Flight parameters (see the note about hot reconfiguration)
+    FlightParameters           flightParameters; // Parameters in use
+    FlightParameters    pendingFlightParameters; // Parameters changed through the serial port
+    bool  hasPendingFlightParameters {false}; // True if the pending parameters must be applied
 
     // Last time of the message on the serial monitor
     unsigned long int timeOfTheLastMessage;
@@ -232,8 +556,51 @@ class RecoverySystem
     // Input message parser
     MessageParser parser;
 
+    // Output message writer (see MessageWriter.h)
+    MessageWriter writer;
+
+    // Telemetry (see the note about the telemetry)
+    struct TelemetrySample
+    {
+      uint16_t          step; // Time step
+      float         altitude; // Altitude AGL (m)
+      float            speed; // Speed (m/s)
+      float     acceleration; // Acceleration (m/s2)
+      char             state; // State code
+      uint8_t     eventFlags; // Conditions of the events
+    };
+    static constexpr uint8_t telemetryAllFields {0x3F}; // Mask of all the fields of the telemetry
+    TelemetrySample             telemetrySample; // Last sample
+    bool            hasTelemetrySample {false}; // True if the last sample was not sent yet
+    uint8_t            telemetryDecimation {0}; // Number of time steps per sample (0 = off)
+    uint8_t             telemetryCountdown {0}; // Number of time steps up to the next sample
+    uint8_t telemetryFields {telemetryAllFields}; // Mask of the fields of the telemetry
+
+    // Cursor of the report (see the note about the report)
+    static constexpr uint8_t reportRecordsPerRun   {4}; // Maximum number of records sent per run of the report task
+    static constexpr uint8_t reportMinimumTxSpace {32}; // Free bytes of the transmit buffer required to send a record
+    uint16_t                reportNextRecord       {0}; // Next record to be sent
+    uint16_t                reportNumberOfRecords  {0}; // Number of records of the report (0 if idle)
+    uint16_t                reportHfSlot           {0}; // Slot up to which the altitudes are written at the higher rate
+
+    // Cursor of the log download (see the note about the log download)
+    static constexpr uint8_t logBlockMinimumTxSpace {ParametersStatic::logBlockSize + 9}; // Free bytes of the transmit buffer required to send a block (a whole binary frame)
+    uint16_t                logNextOffset          {0}; // Offset of the next block (bytes)
+    uint16_t                logRemainingBlocks     {0}; // Number of blocks still to be sent (0 if idle)
+
     // Kalman Filter
     KalmanAlphaFilterFlightStatistics kalmanFilter;
+
+    // Task scheduler of the main loop (see the note about the task scheduler)
+    static constexpr uint8_t flightTaskPriority        {0};
+    static constexpr uint8_t loggingTaskPriority       {1};
+    static constexpr uint8_t userInterfaceTaskPriority {2};
+    static constexpr uint8_t serialTaskPriority        {3};
+    static constexpr uint8_t telemetryTaskPriority     {4};
+    static constexpr uint8_t reportTaskPriority        {5};
+    static constexpr uint8_t logDownloadTaskPriority   {6};
+    static constexpr uint8_t numberOfTasks             {7};
+    Scheduler<RecoverySystem, numberOfTasks> scheduler;
 };
 
 #endif // RECOVERYSYSTEM_H
@@ -0,0 +1,169 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "Sampler.h"
+
+#if defined(__AVR__)
+
+// Instance driven by the timer interrupt
+static Sampler* timerSampler {nullptr};
+
+// Timer1 compare match interrupt. Interrupts are enabled again at the entry (see the note about the sample queue)
+ISR(TIMER1_COMPA_vect, ISR_NOBLOCK)
+{
+  if ( timerSampler != nullptr ) timerSampler->tick();
+}
+
+#endif
+
+
+bool Sampler::begin(Barometer& barometer, uint16_t period)
+{
+  stop();
+
+  this->barometer = &barometer;
+
+#if defined(__AVR__)
+  // Timer1 counts at F_CPU/64 (250 kHz at 16 MHz). OCR1A is a 16-bit register.
+  uint32_t top = ( F_CPU / 64000UL ) * period;
+  if ( top == 0 || top > 65536UL ) return false;
+
+  timerSampler = this;
+
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1  = 0;
+  OCR1A  = (uint16_t)(top - 1);
+  TCCR1B = _BV(WGM12) | _BV(CS11) | _BV(CS10); // CTC mode, prescaler 64
+  TIFR1  = _BV(OCF1A);
+  TIMSK1 = _BV(OCIE1A);
+  running = true;
+  interrupts();
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+void Sampler::stop()
+{
+#if defined(__AVR__)
+  // tick() cannot be in progress here, since the main loop does not run while the interrupt is served
+  TIMSK1 &= ~_BV(OCIE1A);
+#endif
+  running = false;
+  head = 0;
+  tail = 0;
+  discarded = 0;
+  delivered = 0;
+}
+
+
+bool Sampler::pop(float& altitude, bool& fresh, uint32_t& time)
+{
+  uint8_t currentHead = head;
+
+  if ( tail != currentHead )
+  {
+    const volatile Sample& sample = queue[tail & (capacity-1)];
+    altitude = sample.altitude;
+    fresh = sample.fresh;
+    time = sample.time;
+    lastAltitude = altitude;
+    lastTime = time;
+
+    // The slot is released only after it was copied
+    tail = tail + 1;
+    return true;
+  }
+
+  // Delivering the readings discarded by overruns
+  if ( delivered != discarded )
+  {
+    altitude = lastAltitude;
+    fresh = false;
+    time = lastTime;
+    delivered = delivered + 1;
+    return true;
+  }
+
+  return false;
+}
+
+
+uint16_t Sampler::getNumberOfOverruns()
+{
+  noInterrupts();
+  uint16_t n = overruns;
+  interrupts();
+  return n;
+}
+
+
+uint16_t Sampler::getNumberOfMissedTicks()
+{
+  noInterrupts();
+  uint16_t n = missedTicks;
+  interrupts();
+  return n;
+}
+
+
+void Sampler::tick()
+{
+  if ( reading )
+  {
+    missedTicks = missedTicks + 1;
+    return;
+  }
+  reading = true;
+
+  uint32_t time = micros();
+  float altitude = barometer->getAltitude();
+  bool fresh = barometer->isFresh();
+
+  uint8_t currentHead = head;
+
+  if ( (uint8_t)( currentHead - tail ) < capacity )
+  {
+    volatile Sample& sample = queue[currentHead & (capacity-1)];
+    sample.altitude = altitude;
+    sample.fresh = fresh;
+    sample.time = time;
+
+    // The slot is published only after it was written
+    head = currentHead + 1;
+  }
+  else
+  {
+    overruns = overruns + 1;
+    discarded = discarded + 1;
+  }
+
+  reading = false;
+}
@@ -0,0 +1,117 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "Arduino.h"
+#include "Barometer.h"
+
+/*
+
+  Sampler class reads the barometer at the tick of a hardware timer (Timer1 of the ATmega328)
+  and pushes the readings into a queue, which is consumed by the main loop. Hence, the instants
+  of the readings do not depend on how busy the main loop is (delays, reports, etc).
+
+*/
+
+/*
+  Note about the sample queue
+  ---------------------------
+
+  The queue is a ring buffer with a single producer (the timer interrupt) and a single consumer
+  (the main loop). The producer only writes head and the consumer only writes tail. Since both 
+  indexes are single bytes, their reading and writing are atomic and no lock is required.
+
+  The interrupt is declared with ISR_NOBLOCK, so that the I2C (or SPI) transfer and millis() keep 
+  working inside of it. A tick that arrives while a reading is in progress is counted as a 
+  missed tick. A reading that does not fit in the queue is discarded and counted as an overrun. 
+  Each discarded reading is still delivered by pop() as a stale reading (fresh = false), 
+  so that the number of readings consumed keeps in step with the time.
+
+  The timer is only available on AVR boards. In other boards, begin() returns false and the
+  readings must be polled by the main loop.
+*/
+
+class Sampler
+{
+  public:
+
+    /*
+      Initializes Timer1 to tick every period (ms) and starts reading the barometer.
+      Returns false if the timer is not available or if the period is out of range.
+    */
+    bool begin(Barometer& barometer, uint16_t period);
+
+    // Stops the timer ticks and clears the queue
+    void stop();
+
+    // Returns true if the timer is ticking
+    bool isRunning(){return running;};
+
+    /*
+      Pops the oldest reading from the queue. Returns false if no reading is available.
+      fresh is false if the reading is a repetition of the previous one or if it was discarded 
+      by an overrun (see the note about the sample queue). time is the instant of the reading 
+      (microseconds).
+    */
+    bool pop(float& altitude, bool& fresh, uint32_t& time);
+
+    // Returns the number of readings discarded because the queue was full
+    uint16_t getNumberOfOverruns();
+
+    // Returns the number of ticks missed because the previous reading was in progress
+    uint16_t getNumberOfMissedTicks();
+
+    // Reads the barometer and pushes the reading into the queue (called by the timer interrupt)
+    void tick();
+
+  private:
+
+    struct Sample
+    {
+      float    altitude;
+      bool     fresh;
+      uint32_t time;
+    };
+
+    static constexpr uint8_t capacity {8}; // Capacity of the queue (must be a power of 2)
+    static_assert((capacity & (capacity-1)) == 0, "The capacity of the sample queue must be a power of 2");
+
+    volatile Sample queue[capacity];       // Ring buffer of readings
+    volatile uint8_t head {0};             // Number of readings pushed (written only by the producer)
+    volatile uint8_t tail {0};             // Number of readings popped (written only by the consumer)
+    volatile uint8_t discarded {0};        // Number of readings discarded by overruns (written only by the producer)
+    volatile uint8_t delivered {0};        // Number of discarded readings delivered as stale (written only by the consumer)
+    volatile uint16_t overruns {0};        // Readings discarded because the queue was full
+    volatile uint16_t missedTicks {0};     // Ticks that arrived while a reading was in progress
+    volatile bool reading {false};         // Lock against reentrance of tick()
+    volatile bool running {false};         // True if the timer is ticking
+    float lastAltitude {0};                // Last altitude popped (repeated by the stale readings)
+    uint32_t lastTime {0};                 // Instant of the last reading popped (microseconds)
+    Barometer* barometer {nullptr};        // Barometer read by the producer
+};
+
+#endif // SAMPLER_H
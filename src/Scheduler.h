@@ -0,0 +1,162 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "Arduino.h"
+
+/*
+
+  Scheduler runs the tasks of an owner object cooperatively, according to their priorities.
+
+  Each call to run() is a pass. In a pass, every task that is due runs once. A task is due if 
+  its period (ms) has elapsed since its last release. Tasks of period 0 are due in every pass.
+  Before each task, the highest priority due task is chosen again, so that a task released 
+  during the pass (e.g., sensing) runs before the remaining lower priority tasks of the pass.
+  Since the tasks are not preempted, the latency of a task is bounded by the longest run 
+  time of the lower priority tasks.
+
+  The scheduler tracks the worst-case run time of each task and the number of deadline misses.
+  A deadline is missed if a task finishes more than 'deadline' ms after its release. The
+  release of a task of period 0 is the end of its previous run, so its deadline bounds the
+  interval between two consecutive runs.
+
+*/
+
+template <class Owner, uint8_t numberOfTasks>
+class Scheduler
+{
+  public:
+
+    typedef void (Owner::*TaskFunction)();
+
+    // Initializes the tasks of the owner. Priority 0 is the highest one.
+    void begin(Owner* owner)
+    {
+      this->owner = owner;
+      reset();
+    }
+
+    // Sets the task of the given priority
+    void setTask(uint8_t priority, TaskFunction function, uint16_t period, uint16_t deadline)
+    {
+      Task& task = tasks[priority];
+      task.function = function;
+      task.period = period;
+      task.deadline = deadline;
+    }
+
+    // Restarts the releases and the statistics of all tasks
+    void reset()
+    {
+      uint32_t currentTime = micros();
+      for (uint8_t i = 0; i < numberOfTasks; ++i)
+      {
+        tasks[i].release = currentTime;
+        tasks[i].worstCaseTime = 0;
+        tasks[i].deadlineMisses = 0;
+      }
+      wasReset = true;
+    }
+
+    // Runs one pass
+    void run()
+    {
+      for (uint8_t i = 0; i < numberOfTasks; ++i)
+      {
+        tasks[i].done = false;
+      }
+
+      for (uint8_t i = 0; i < numberOfTasks; )
+      {
+        Task& task = tasks[i];
+
+        if ( task.done || task.function == nullptr || ! isDue(task, micros()) )
+        {
+          ++i;
+          continue;
+        }
+
+        uint32_t startTime = micros();
+
+        // Release served by this run. The releases lost while the task was late are skipped.
+        if ( task.period > 0 )
+        {
+          task.release += 1000UL * task.period;
+          if ( isDue(task, startTime) ) task.release = startTime;
+        }
+
+        wasReset = false;
+        (owner->*task.function)();
+        uint32_t endTime = micros();
+
+        // A task that restarts the scheduler (e.g., by reinitializing the owner) is not accounted
+        task.done = true;
+        if ( ! wasReset )
+        {
+          if ( endTime - startTime > task.worstCaseTime ) task.worstCaseTime = endTime - startTime;
+          if ( endTime - task.release > 1000UL * task.deadline ) task.deadlineMisses++;
+        }
+
+        // The next release of a task of period 0 is the end of this run
+        if ( task.period == 0 ) task.release = endTime;
+
+        // Restarting from the highest priority
+        i = 0;
+      }
+    }
+
+    // Returns the worst-case run time of the task (microseconds)
+    uint32_t getWorstCaseTime(uint8_t priority){return tasks[priority].worstCaseTime;};
+
+    // Returns the number of deadline misses of the task
+    uint16_t getDeadlineMisses(uint8_t priority){return tasks[priority].deadlineMisses;};
+
+  private:
+
+    struct Task
+    {
+      TaskFunction     function {nullptr}; // Member function of the owner
+      uint16_t               period {0}; // Period (ms), 0 = every pass
+      uint16_t             deadline {0}; // Maximum time from the release to the end of the run (ms)
+      uint32_t              release {0}; // Time of the last release (microseconds)
+      uint32_t        worstCaseTime {0}; // Worst-case run time (microseconds)
+      uint16_t       deadlineMisses {0}; // Number of deadline misses
+      bool                  done {false}; // True if the task ran in the current pass
+    };
+
+    // Returns true if the next release of the task (one period after the last one) is at or before currentTime
+    static bool isDue(const Task& task, uint32_t currentTime)
+    {
+      return ( task.period == 0 || (int32_t)( currentTime - task.release ) >= (int32_t)( 1000UL * task.period ) );
+    }
+
+    Owner*         owner {nullptr}; // Owner of the tasks
+    bool          wasReset {false}; // True if reset() was called during the run of a task
+    Task    tasks[numberOfTasks]; // Tasks sorted by priority
+};
+
+#endif // SCHEDULER_H
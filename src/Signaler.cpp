@@ -0,0 +1,126 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "Arduino.h"
+#include "Signaler.h"
+
+void Signaler::begin(uint8_t pinLed, uint8_t pinBuzzer)
+{
+  this->pinLed = pinLed;
+  this->pinBuzzer = pinBuzzer;
+  stop();
+}
+
+bool Signaler::queueDigit(uint8_t digit)
+{
+  if ( (uint8_t)(queueHead - queueTail) == queueCapacity ) return false;
+
+  queue[queueHead & (queueCapacity-1)] = digit;
+  queueHead++;
+  return true;
+}
+
+void Signaler::queueNumber(uint16_t n)
+{
+  uint16_t divisor = 1;
+  while ( n / divisor >= 10 ) divisor *= 10;
+
+  for ( ; divisor > 0; divisor /= 10 )
+  {
+    queueDigit( ( n / divisor ) % 10 );
+  }
+}
+
+void Signaler::update()
+{
+  if ( phase == Phase::idle )
+  {
+    if ( queueHead == queueTail ) return;
+
+    // Starting the next digit
+    digit = queue[queueTail & (queueCapacity-1)];
+    queueTail++;
+    remainingBlinks = ( digit == 0 ? 1 : digit );
+    startPhase(Phase::off, offTime);
+    return;
+  }
+
+  if ( (int32_t)( millis() - phaseEndTime ) < 0 ) return;
+
+  switch (phase)
+  {
+    case Phase::off:
+      startPhase(Phase::on, ( digit == 0 ? longOnTime : onTime ));
+      break;
+
+    case Phase::on:
+      remainingBlinks--;
+      if ( remainingBlinks > 0 )
+      {
+        startPhase(Phase::off, offTime);
+      }
+      else
+      {
+        startPhase(Phase::pause, pauseTime);
+      }
+      break;
+
+    case Phase::pause:
+      phase = Phase::idle;
+      break;
+
+    default:
+      break;
+  }
+}
+
+void Signaler::stop()
+{
+  queueHead = 0;
+  queueTail = 0;
+  phase = Phase::idle;
+  set(false);
+}
+
+void Signaler::set(bool on)
+{
+  if ( on )
+  {
+    digitalWrite(pinLed, HIGH);
+    tone(pinBuzzer, frequency);
+  }
+  else
+  {
+    digitalWrite(pinLed, LOW);
+    noTone(pinBuzzer);
+  }
+}
+
+void Signaler::startPhase(Phase phase, uint16_t duration)
+{
+  this->phase = phase;
+  set( phase == Phase::on );
+  phaseEndTime = millis() + duration;
+}
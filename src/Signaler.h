@@ -0,0 +1,97 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#ifndef SIGNALER_H
+#define SIGNALER_H
+
+#include <inttypes.h>
+
+/*
+
+  Signaler shows numbers to the user through the led and the buzzer without blocking the main loop.
+
+  The digits to be shown are queued. Each digit d is shown as d blinks (a long blink if d = 0), 
+  followed by a pause:
+
+          d blinks (300 ms on, 300 ms off)             pause (500 ms)
+      ___     ___           ___
+  ___|   |___|   |___ ... _|   |______________________
+
+  The blinks of a digit are expanded only while the digit is shown, so that a queued digit 
+  occupies a single byte. The method update() must be called periodically (e.g., every 10 ms).
+
+*/
+
+class Signaler
+{
+  public:
+
+    // Initializes
+    void begin(uint8_t pinLed, uint8_t pinBuzzer);
+
+    // Queues a digit (0 to 9). Returns false if the queue is full.
+    bool queueDigit(uint8_t digit);
+
+    // Queues the digits of n, starting from the most significant one
+    void queueNumber(uint16_t n);
+
+    // Turns the led and the buzzer on or off according to the current time
+    void update();
+
+    // Clears the queue and turns the led and the buzzer off
+    void stop();
+
+    // Returns true if a digit is being shown
+    bool isBusy(){return phase != Phase::idle;};
+
+  private:
+
+    enum class Phase : uint8_t {idle, off, on, pause};
+
+    // Turns the led and the buzzer on or off
+    void set(bool on);
+
+    // Starts a phase that lasts duration milliseconds
+    void startPhase(Phase phase, uint16_t duration);
+
+    static constexpr uint16_t       onTime  {300}; // Duration of a blink (ms)
+    static constexpr uint16_t   longOnTime {1000}; // Duration of the blink of the digit 0 (ms)
+    static constexpr uint16_t      offTime  {300}; // Interval before a blink (ms)
+    static constexpr uint16_t    pauseTime  {500}; // Interval after a digit (ms)
+    static constexpr uint16_t    frequency  {600}; // Frequency of the buzzer (Hz)
+    static constexpr uint8_t queueCapacity    {8}; // Capacity of the queue of digits (power of 2)
+
+    uint8_t              pinLed {0}; // Pin of the led
+    uint8_t           pinBuzzer {0}; // Pin of the buzzer
+    uint8_t queue[queueCapacity] {}; // Queue of digits (ring buffer)
+    uint8_t           queueHead {0}; // Number of digits queued
+    uint8_t           queueTail {0}; // Number of digits dequeued
+    uint8_t               digit {0}; // Digit being shown
+    uint8_t     remainingBlinks {0}; // Number of blinks of the digit still to be shown
+    Phase    phase {Phase::idle}; // Current phase
+    uint32_t       phaseEndTime {0}; // End of the current phase (ms)
+};
+
+#endif // SIGNALER_H
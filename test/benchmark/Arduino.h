@@ -0,0 +1,65 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+  Minimal host replacement of the Arduino core for the checks of the modules that send
+  messages through the serial port (see MessageWriterCheck.cpp). The program memory is
+  the ordinary memory and the serial port only counts the bytes written.
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+#define pgm_read_ptr(address) (*(const void* const*)(address))
+class __FlashStringHelper;
+
+unsigned long micros();
+
+class HostSerial
+{
+  public:
+    size_t write(const uint8_t* data, size_t n)
+    {
+      numberOfBytes += n;
+      lastLength = ( n < sizeof(last) ? n : sizeof(last) );
+      memcpy(last, data, lastLength);
+      return n;
+    }
+    int availableForWrite(){return 63;}
+    size_t numberOfBytes {0}; // Number of bytes written
+    uint8_t       last[128]; // Last bytes written
+    size_t   lastLength {0}; // Number of the last bytes written
+};
+
+extern HostSerial Serial;
+
+#endif // ARDUINO_H
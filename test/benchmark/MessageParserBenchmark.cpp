@@ -0,0 +1,366 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+  Host benchmark of MessageParser
+  -------------------------------
+
+  Measures the throughput (bytes per second) of the message parser of the firmware and of
+  the former parser (copied below as LegacyMessageParser), which shifted its buffers and 
+  searched the messages again on every call. The input stream mimics a simulation session: 
+  altitude messages mixed with garbage, delivered in small chunks, as read from the serial 
+  port by RecoverySystem::listenForMessages.
+
+  Compiling and running (from this directory):
+    g++ -O2 -std=c++11 -I../../src MessageParserBenchmark.cpp ../../src/MessageParser.cpp -o benchmark
+    ./benchmark
+*/
+
+#include "MessageParser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define MSGPARSERLEGACYMAXSIZE 32
+#define MSGPARSERLEGACYMAXFIELDS 2
+
+namespace legacy
+{
+
+class LegacyMessageParser
+{
+public:
+    void begin(char BS='<', char FS=',', char ES='>');
+    void append(char ch);
+    bool hasMessage();
+    void getEntryStr(const int& entryNumber, char*  entry);
+    int  getEntryInt(const int& entryNumber);
+    float getEntryFloat(const int& entryNumber);
+
+    char                      BS {'<'};
+    char                      FS {','};
+    char                      ES {'>'};
+    char         str[MSGPARSERLEGACYMAXSIZE+1] {}; // One more element than the former parser, which wrote past the end of the array when full
+    char         msg[MSGPARSERLEGACYMAXSIZE] {};
+    uint8_t idxvec[MSGPARSERLEGACYMAXFIELDS+1]; // Idem
+    uint16_t           numberOfEntries {0};
+
+private:
+    void parseMessage();
+};
+
+int findFirst(const char *str, char pattern)
+{
+    for (size_t i = 0; i < strlen(str); ++i)
+    {
+        if (str[i] == pattern)
+            return i;
+    }
+    return -1;
+}
+
+/*
+    Finds the index of the last occurence 
+    of pattern char in str.
+    If the pattern is absent, returns -1.
+*/
+int findLast(const char *str, char pattern)
+{
+    for (size_t i = strlen(str); i > 0; --i)
+    {
+        if (str[i-1] == pattern)
+            return i-1;
+    }
+    return -1;
+}
+
+/*
+    Shift a string left
+*/
+void shiftLeft(char *str, int shift)
+{
+    int sz = strlen(str);
+
+    if (shift < 0)
+        return;
+
+    if (shift >= sz)
+    {
+        str[0] = '\0';
+        return;
+    }
+
+    for (int i = 0; i < sz - shift; ++i)
+    {
+        str[i] = str[i + shift];
+    }
+    str[sz - shift] = '\0';
+}
+
+void searchMessage(char *str, char *msg, char bExp, char eExp)
+{
+    bool searchCompleted = false;
+
+    int idxB, idxE;
+
+    while (!searchCompleted)
+    {
+        // Getting the first occurence of eExp
+        idxE = findFirst(str, eExp);
+
+        // Cleaning the message
+        msg[0] = '\0';
+
+        // If end pattern was found
+        if (idxE >= 0)
+        {
+            // Copying the first part of the pattern to msg
+            strncpy(msg, str, idxE);
+
+            // Setting the end of message
+            msg[idxE] = '\0';
+
+            // Shifting the str (removing the copied part)
+            shiftLeft(str, idxE + 1);
+
+            // Looking for the last occurrence of the start pattern in msg
+            idxB = findLast(msg, bExp);
+
+            // If start pattern was found
+            if (idxB >= 0)
+            {
+                // Formatting the message
+                shiftLeft(msg, idxB + 1);
+                searchCompleted = true;
+            }
+            else
+            {
+                // Message undefined
+                msg[0] = '\0';
+                searchCompleted = false;
+            }
+        }
+        // If end pattern was NOT found
+        else
+        {
+            searchCompleted = true;
+
+            // Looking for the last occurrence of the start pattern in str
+            idxB = findLast(str, bExp);
+
+            // If start pattern was found
+            if (idxB >= 0)
+            {
+                // Removing unnecessary text
+                shiftLeft(msg, idxB);
+            }
+        }
+    }
+}
+
+void LegacyMessageParser::begin(char bs, char fs, char es)
+{
+    this->BS = bs;
+    this->ES = es;
+    this->FS = fs;
+}
+
+void LegacyMessageParser::append(char ch)
+{
+    // Ignores new line, return carriage and null characters
+    if (!(ch == '\n' || ch == '\r' || ch == '\0'))
+    {
+        // If the str is full, shift it left
+        size_t sz = strlen(str);
+        if (sz == MSGPARSERLEGACYMAXSIZE)
+        {
+            for (size_t i = 0; i < MSGPARSERLEGACYMAXSIZE - 1; ++i)
+                str[i] = str[i + 1];
+            sz--;
+        }
+
+        // Copying the input data
+        str[sz] = ch;
+        str[sz + 1] = '\0';
+    }
+}
+
+bool LegacyMessageParser::hasMessage()
+{
+    // Searching for a message between BS and ES in str.
+    // If a message is found, it is moved from str to msg
+    // and the function returns true.
+
+    searchMessage(str, msg, BS, ES);
+    parseMessage();
+
+    return (strlen(msg) > 0 ? true : false);
+}
+
+void LegacyMessageParser::getEntryStr(const int& entryNumber, char*  entry)
+{
+    // Initializing the output
+    entry[0] = '\0';
+
+    // Is the entryNumber valid?
+    if ( entryNumber < numberOfEntries )
+    {
+        // Copy the entry
+        int16_t idxB = idxvec[entryNumber];
+        int16_t idxE = idxvec[entryNumber+1];
+        if ( idxE > idxB ) 
+        {
+            strncpy(entry,&msg[idxB],idxE-idxB);
+            entry[idxE-idxB-1]='\0';
+        }
+    }
+}
+
+int LegacyMessageParser::getEntryInt(const int& entryNumber)
+{
+    char buffer[35];
+    getEntryStr(entryNumber,buffer);
+    return atoi(buffer);
+}
+
+float LegacyMessageParser::getEntryFloat(const int& entryNumber)
+{
+    char buffer[35];
+    getEntryStr(entryNumber,buffer);
+    return atof(buffer);
+}
+
+void LegacyMessageParser::parseMessage()
+{
+    size_t sz = strlen(msg);
+
+    // If the message is empty, the number of entries is zero.
+    // Just return...
+    if ( sz < 1 )
+    {
+        numberOfEntries = 0;
+        return;
+    }
+
+    // If the message is not empty, there exist,
+    // at least, one entry.
+    numberOfEntries = 1;
+    idxvec[0]=0;
+    for (size_t i=0; i<sz; ++i)
+    {
+        if (msg[i]==FS)
+        {
+            idxvec[numberOfEntries]=i+1;
+            numberOfEntries++;
+        }
+    }
+    idxvec[numberOfEntries]=sz+1;
+}
+
+} // namespace legacy
+
+
+// Builds the input stream: altitude messages, requests of the flight report and some garbage
+static std::string buildStream(size_t numberOfMessages)
+{
+    std::string s;
+    srand(1);
+    for (size_t i = 0; i < numberOfMessages; ++i)
+    {
+        char buffer[32];
+        switch ( rand() % 8 )
+        {
+            case 0:  snprintf(buffer, sizeof(buffer), "xx<5>\r\n"); break;
+            case 1:  snprintf(buffer, sizeof(buffer), "~%c<7,%d>\n", (char)(33 + rand() % 90), rand() % 300000); break;
+            default: snprintf(buffer, sizeof(buffer), "<7,%d>\n", rand() % 300000); break;
+        }
+        s += buffer;
+    }
+    return s;
+}
+
+// Returns the sum of the entries of the last message
+static long sumEntries(legacy::LegacyMessageParser& parser)
+{
+    return parser.getEntryInt(0) + parser.getEntryInt(1);
+}
+
+static long sumEntries(MessageParser& parser)
+{
+    int32_t code = 0, value = 0;
+    parser.getEntryInt(0, code);
+    parser.getEntryInt(1, value);
+    return code + value;
+}
+
+// Feeds the stream to the parser in chunks and returns the throughput (bytes/s)
+template <class Parser>
+static double run(const std::string& s, size_t chunk, size_t repetitions, long& messages, long& checksum)
+{
+    Parser parser;
+    parser.begin();
+    messages = 0;
+    checksum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+        for (size_t i = 0; i < s.size(); i += chunk)
+        {
+            for (size_t j = i; j < i + chunk && j < s.size(); ++j)
+            {
+                parser.append(s[j]);
+            }
+            while ( parser.hasMessage() )
+            {
+                messages++;
+                checksum += sumEntries(parser);
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    return s.size() * repetitions / seconds;
+}
+
+int main()
+{
+    const std::string s = buildStream(10000);
+    const size_t repetitions = 50;
+
+    printf("stream: %zu bytes x %zu\n", s.size(), repetitions);
+    printf("%6s %16s %16s %8s %12s %12s\n", "chunk", "legacy (B/s)", "current (B/s)", "speedup", "legacy msgs", "current msgs");
+    for (size_t chunk : {1, 4, 16})
+    {
+        long legacyMessages, legacyChecksum, currentMessages, currentChecksum;
+        double legacyRate  = run<legacy::LegacyMessageParser>(s, chunk, repetitions, legacyMessages, legacyChecksum);
+        double currentRate = run<MessageParser>(s, chunk, repetitions, currentMessages, currentChecksum);
+        printf("%6zu %16.3e %16.3e %8.2f %12ld %12ld%s\n", chunk, legacyRate, currentRate, currentRate / legacyRate, 
+            legacyMessages, currentMessages, ( legacyChecksum == currentChecksum ? "" : " (different entries)" ));
+    }
+    return 0;
+}
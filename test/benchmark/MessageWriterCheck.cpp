@@ -0,0 +1,308 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (C) 2022 Guilherme Bertoldo and Jonas Joacir Radtke
+  (UTFPR) Federal University of Technology - Parana
+
+  Permission is hereby granted, free of charge, to any person obtaining a 
+  copy of this software and associated documentation files (the “Software”), 
+  to deal in the Software without restriction, including without limitation 
+  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+  and/or sell copies of the Software, and to permit persons to whom the Software 
+  is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all 
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN 
+  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+  Host check of the output formatter of MessageWriter
+  ---------------------------------------------------
+
+  Compares the ASCII messages formatted by MessageWriter with an exact reference formatted by 
+  snprintf from the same integers. The messages are those sent the most (the flight path of the
+  report, the state of the simulation and the fixed-point parameters of the Kalman filter) and
+  the limits of the integer types. Every MessageWriter output must match the reference.
+
+  The former path (the Arduino Print formatting, copied below as LegacyWriter, and the conversion
+  of the altitudes read from the memory to float and back) is compared to the same reference, to
+  show the values it got wrong. Both paths send the same text, e.g. the flight path in integer 
+  decimeters, so a legacy deviation is a wrong value, not a different format.
+
+  No timing is made: the time on the host does not reflect the time on the ATmega328. The run time
+  of the report records and of the simulation state is measured on the target by the profiler
+  (stages reportRecord and simulationState, see Profiler.h), read by icode::readStageTimings.
+
+  Compiling and running (from this directory, which provides a minimal Arduino.h):
+    g++ -O2 -std=c++11 -I. -I../../src MessageWriterCheck.cpp ../../src/MessageWriter.cpp -o check
+    ./check
+*/
+
+#include "MessageWriter.h"
+#include "ParametersStatic.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+HostSerial Serial;
+
+unsigned long micros()
+{
+    return 0;
+}
+
+namespace legacy
+{
+
+// Formats the messages as the former firmware did through Serial.print
+class LegacyWriter
+{
+public:
+    void start(uint8_t code)
+    {
+        text = "<";
+        printNumber(code);
+    }
+
+    void add(long value)
+    {
+        text += ',';
+        if ( value < 0 )
+        {
+            text += '-';
+            value = -value;
+        }
+        printNumber((unsigned long) value);
+    }
+
+    void add(float value, uint8_t decimals)
+    {
+        text += ',';
+        printFloat(value, decimals);
+    }
+
+    void add(char value)
+    {
+        text += ',';
+        text += value;
+    }
+
+    std::string end()
+    {
+        return text + ">\r\n";
+    }
+
+private:
+    void printNumber(unsigned long n)
+    {
+        char digits[11];
+        char* str = &digits[sizeof(digits) - 1];
+        *str = '\0';
+        do
+        {
+            char c = n % 10;
+            n /= 10;
+            *--str = c + '0';
+        }
+        while ( n );
+        text += str;
+    }
+
+    void printFloat(double number, uint8_t decimals)
+    {
+        if ( number < 0.0 )
+        {
+            text += '-';
+            number = -number;
+        }
+        double rounding = 0.5;
+        for (uint8_t i = 0; i < decimals; ++i) rounding /= 10.0;
+        number += rounding;
+
+        unsigned long integerPart = (unsigned long) number;
+        double remainder = number - (double) integerPart;
+        printNumber(integerPart);
+
+        if ( decimals > 0 ) text += '.';
+        while ( decimals-- > 0 )
+        {
+            remainder *= 10.0;
+            unsigned int digit = (unsigned int) remainder;
+            printNumber(digit);
+            remainder -= digit;
+        }
+    }
+
+    std::string text;
+};
+
+} // namespace legacy
+
+// Exact reference: the integer value with the given number of decimals
+static std::string fixed(long long value, int decimals)
+{
+    char text[32];
+    if ( decimals == 0 )
+    {
+        snprintf(text, sizeof(text), "%lld", value);
+        return text;
+    }
+    long long scale = 1;
+    for (int i = 0; i < decimals; ++i) scale *= 10;
+    long long magnitude = ( value < 0 ? -value : value );
+    snprintf(text, sizeof(text), "%s%lld.%0*lld", ( value < 0 ? "-" : "" ), magnitude / scale, decimals, magnitude % scale);
+    return text;
+}
+
+static std::string message(uint8_t code, const std::vector<std::string>& fields)
+{
+    std::string text = "<" + std::to_string(code);
+    for (const std::string& field : fields) text += "," + field;
+    return text + ">\r\n";
+}
+
+// Returns the last message written by MessageWriter
+static std::string lastMessage()
+{
+    return std::string((const char*) Serial.last, Serial.lastLength);
+}
+
+static MessageWriter writer;
+static legacy::LegacyWriter legacyWriter;
+
+// Number of messages checked, of MessageWriter mismatches and of legacy deviations of each case
+struct Result
+{
+    size_t messages {0};
+    size_t mismatches {0};
+    size_t legacyDeviations {0};
+
+    void count(const std::string& reference, const std::string& current, const std::string& legacy)
+    {
+        messages++;
+        if ( current != reference )
+        {
+            if ( mismatches == 0 ) printf("  expected %s  got %s", reference.c_str(), current.c_str());
+            mismatches++;
+        }
+        if ( legacy != reference ) legacyDeviations++;
+    }
+};
+
+static void print(const char* name, const Result& r)
+{
+    printf("%14s %10zu %12zu %18zu\n", name, r.messages, r.mismatches, r.legacyDeviations);
+}
+
+int main()
+{
+    printf("%14s %10s %12s %18s\n", "message", "checked", "mismatches", "legacy deviations");
+    size_t mismatches = 0;
+    srand(1);
+
+    // Flight path: the stored altitude (h+500)*10 (see Memory.h) is shown in decimeters
+    Result path;
+    for (uint32_t stored = 0; stored <= 65535; ++stored)
+    {
+        int32_t t = 100 * (int32_t)( stored % 3000 );
+        int32_t dm = (int32_t) stored - 5000;
+
+        writer.start(ocode::flightPath);
+        writer.add(t);
+        writer.add(dm);
+        writer.end();
+
+        // The legacy path read the altitude as float (Memory::readAltitude, double is float on AVR) and truncated it to decimeters
+        float h = (float) stored * 0.1f - 500.0f;
+        int32_t legacyDm = (int32_t)( 10.0f * h );
+
+        legacyWriter.start(ocode::flightPath);
+        legacyWriter.add((long) t);
+        legacyWriter.add((long) legacyDm);
+
+        path.count(message(ocode::flightPath, {fixed(t, 0), fixed(dm, 0)}), lastMessage(), legacyWriter.end());
+    }
+    print("flight path", path);
+    mismatches += path.mismatches;
+
+    // State of the simulation: the integers already converted by the caller
+    Result state;
+    for (int i = 0; i < 100000; ++i)
+    {
+        int32_t t = 100 * i;
+        int32_t h = rand() % 300000 - 100;
+        int32_t v = rand() % 60000 - 30000;
+        int32_t a = rand() % 40000 - 20000;
+        char c = "RFDPL"[rand() % 5];
+
+        writer.start(ocode::simulatedFlightState);
+        writer.add(t);
+        writer.add(h);
+        writer.add(v);
+        writer.add(a);
+        writer.add(c);
+        writer.end();
+
+        legacyWriter.start(ocode::simulatedFlightState);
+        legacyWriter.add((long) t);
+        legacyWriter.add((long) h);
+        legacyWriter.add((long) v);
+        legacyWriter.add((long) a);
+        legacyWriter.add(c);
+
+        state.count(message(ocode::simulatedFlightState, {fixed(t, 0), fixed(h, 0), fixed(v, 0), fixed(a, 0), std::string(1, c)}),
+            lastMessage(), legacyWriter.end());
+    }
+    print("state", state);
+    mismatches += state.mismatches;
+
+    // Parameters of the Kalman filter (fixed-point with 2 decimals)
+    Result parameters;
+    const float values[] {ParametersStatic::kfStdExp, ParametersStatic::kfStdModSub, ParametersStatic::kfStdModTra, ParametersStatic::kfdadt_ref};
+    const uint8_t codes[] {ocode::kfStdExp, ocode::kfStdModSub, ocode::kfStdModTra, ocode::kfDadt_ref};
+    for (int i = 0; i < 4; ++i)
+    {
+        int32_t value = toFixed(values[i], 2);
+        writer.send(codes[i], value);
+
+        legacyWriter.start(codes[i]);
+        legacyWriter.add(values[i], 2);
+
+        parameters.count(message(codes[i], {fixed(value, 2)}), lastMessage(), legacyWriter.end());
+    }
+    print("parameters", parameters);
+    mismatches += parameters.mismatches;
+
+    // Limits of the integer types
+    Result limits;
+    const int32_t signedValues[] {INT32_MIN, INT32_MIN + 1, -1000000000, -1, 0, 1, 9, 10, 999999999, 1000000000, INT32_MAX};
+    for (int32_t value : signedValues)
+    {
+        writer.send(ocode::rejectedParameter, value);
+        legacyWriter.start(ocode::rejectedParameter);
+        legacyWriter.add((long) value);
+        limits.count(message(ocode::rejectedParameter, {fixed(value, 0)}), lastMessage(), legacyWriter.end());
+    }
+    const uint32_t unsignedValues[] {0, 1, 4294967295UL};
+    for (uint32_t value : unsignedValues)
+    {
+        writer.send(ocode::startupTime, value);
+        legacyWriter.start(ocode::startupTime);
+        legacyWriter.add((long) value);
+        limits.count(message(ocode::startupTime, {fixed(value, 0)}), lastMessage(), legacyWriter.end());
+    }
+    print("limits", limits);
+    mismatches += limits.mismatches;
+
+    return ( mismatches == 0 ? 0 : 1 );
+}
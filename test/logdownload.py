@@ -0,0 +1,121 @@
+# Downloads the log of altitudes of the last flight from rRocket (see the note about the log download
+# in src/RecoverySystem.h) and writes the flight path (time (s) and altitude (m)) to a text file.
+#
+# The blocks are requested in windows. The blocks missing or corrupted are requested again. The blocks
+# already verified are kept in <output file>.part, so an interrupted download is resumed by running
+# the tool again. At the end, the CRC of the whole log is checked against the CRC given by rRocket.
+#
+# Usage:
+#   python logdownload.py <serial port> <output file>
+import json
+import os
+import struct
+import sys
+import time
+import serial
+import rrocketprotocol as rp
+
+blocksPerRequest = 16  # Number of blocks requested at once
+maxAttempts      = 10  # Maximum number of requests of the same block
+replyTimeout     = 2.0 # Time to wait for the replies (s)
+
+class Link:
+  def __init__(self, port):
+    self.ser = serial.Serial(port=port,baudrate=115200,timeout=0.01,write_timeout=0.5)
+    self.decoder = rp.Decoder()
+
+  # Sends the command and returns the messages with the given code received until n of them
+  # arrived or the timeout expired
+  def request(self, command, code, n=1):
+    self.ser.write(command)
+    messages = []
+    deadline = time.time()+replyTimeout
+    while len(messages) < n and time.time() < deadline:
+      for message in self.decoder.feed(self.ser.read(self.ser.in_waiting or 1)):
+        if message.code == code:
+          messages.append(message)
+          deadline = time.time()+replyTimeout
+    return messages
+
+# Converts the bytes of the log into the flight path (see Memory.h and RecoverySystem::showReport)
+def flightPath(log, info):
+  deltaT, timeStepScaler, drogue = info['deltaT'], info['timeStepScaler'], info['drogue']
+  n = len(log)//2
+  hfSlot = min(drogue, n)
+  path = []
+  for i, (h,) in enumerate(struct.iter_unpack('<H', log)):
+    if i > hfSlot:
+      t = deltaT*timeStepScaler*(i-hfSlot)+deltaT*hfSlot
+    else:
+      t = deltaT*i
+    path.append((t*1e-3, h*0.1-500.0))
+  return path
+
+if __name__ == "__main__":
+  if len(sys.argv) != 3:
+    print("Usage: python "+sys.argv[0]+" <serial port> <output file>")
+    exit()
+  ofilename = sys.argv[2]
+  partfilename = ofilename+".part"
+
+  link = Link(sys.argv[1])
+  time.sleep(2) # Waiting for the reset of the board
+  link.request(rp.command(21,1), rp.ocode('protocol'))
+
+  reply = link.request(rp.command(22), rp.ocode('logInfo'))
+  if not reply:
+    print("No answer from rRocket.")
+    exit()
+  names = ['size','blockSize','crc','deltaT','timeStepScaler','liftoff','drogue','parachute','landed']
+  info = dict(zip(names, reply[0].fields))
+  size, blockSize = info['size'], info['blockSize']
+  print("Log: %d bytes, CRC %04X" % (size, info['crc']))
+
+  # Resuming the download, if the partial file belongs to the same log
+  blocks = {}
+  if os.path.exists(partfilename):
+    with open(partfilename) as f:
+      part = json.load(f)
+    if part['info'] == info:
+      blocks = {int(k): bytes.fromhex(v) for k, v in part['blocks'].items()}
+      print("Resuming: %d blocks already downloaded" % len(blocks))
+
+  offsets = list(range(0, size, blockSize))
+  attempts = dict.fromkeys(offsets, 0)
+  start = time.time()
+  while True:
+    missing = [o for o in offsets if o not in blocks]
+    if not missing:
+      break
+    # Requesting a window of consecutive blocks from the first missing one
+    first = missing[0]
+    if attempts[first] == maxAttempts:
+      print("Block %d could not be downloaded." % first)
+      break
+    window = [o for o in missing if o < first+blocksPerRequest*blockSize]
+    count = (window[-1]-first)//blockSize+1
+    for o in window:
+      attempts[o] += 1
+    for message in link.request(rp.command(23,first,count), rp.ocode('logBlock'), count):
+      offset, crc, data = message.fields
+      if offset in attempts and offset not in blocks and rp.crc16(data) == crc:
+        blocks[offset] = data
+    with open(partfilename,"w") as f:
+      json.dump({'info': info, 'blocks': {o: b.hex() for o, b in blocks.items()}}, f)
+    print("\r%d/%d bytes" % (sum(len(b) for b in blocks.values()), size), end="")
+  print(" (%.1f s)" % (time.time()-start))
+
+  link.request(rp.command(21,0), rp.ocode('protocol'))
+
+  log = b"".join(blocks.get(o, b"") for o in offsets)
+  if len(log) != size or rp.crc16(log) != info['crc']:
+    print("The CRC of the log does not match. The partial download is kept in "+partfilename+".")
+    exit()
+
+  with open(ofilename,"w") as f:
+    f.write("# liftoff (s): %g, drogue (s): %g, parachute (s): %g, landed (s): %g\n" % tuple(
+      info[e]*info['deltaT']*1e-3 for e in ['liftoff','drogue','parachute','landed']))
+    for t, h in flightPath(log, info):
+      f.write("%.3f %.1f\n" % (t, h))
+  os.remove(partfilename)
+  print("Flight path written to "+ofilename+".")
@@ -0,0 +1,228 @@
+# Host library of the rRocket serial protocol.
+#
+# The output messages of rRocket are either ASCII text <code,field1,field2,...> or binary frames
+#   sync (0xA5) | code | length | payload | CRC-16/CCITT-FALSE (little-endian)
+# (see src/MessageWriter.h). The codes and the types of the fields of both protocols come from the
+# message table RROCKET_OUTPUT_MESSAGES of src/ParametersStatic.h, which is read by this library.
+#
+# Usage:
+#   decoder = Decoder()
+#   for message in decoder.feed(bytesReadFromTheSerialPort):
+#     print(message.name, message.fields)
+#
+# Decoding a capture of the serial port:
+#   python rrocketprotocol.py <capture file>
+import os
+import re
+import struct
+import sys
+
+sync = 0xA5
+
+defaultTable = os.path.join(os.path.dirname(os.path.abspath(__file__)),"..","src","ParametersStatic.h")
+
+# Reads the message table (code: (name, format)) from ParametersStatic.h
+def loadMessageTable(fileName=defaultTable):
+  with open(fileName) as f:
+    text = f.read()
+  table = {}
+  for name, code, fmt in re.findall(r'X\((\w+),\s*(\d+),\s*"([^"]*)"\)', text):
+    table[int(code)] = (name, fmt)
+  return table
+
+# Returns the code of the output message with the given name
+def ocode(name, table=None):
+  for code, (n, fmt) in (table if table is not None else loadMessageTable()).items():
+    if n == name:
+      return code
+  raise KeyError(name)
+
+# CRC-16/CCITT-FALSE (see src/Crc16.h)
+def crc16(data, crc=0xFFFF):
+  for b in data:
+    crc ^= b << 8
+    for i in range(8):
+      crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+      crc &= 0xFFFF
+  return crc
+
+# Sizes of the binary fields
+fieldSize = {'b':1, 'B':1, 'c':1, 'm':1, 'h':2, 'H':2, 'E':2, 'i':4, 'I':4, 'f':4}
+
+# Divisors that convert integer fields to the units of the host, by message name (the ASCII text
+# keeps the integers, e.g. the altitude of the flight path in decimeters)
+fieldDivisors = {'flightPath': (1, 10)} # time (ms), altitude (dm to m)
+
+# Converts the error log (bit mask) into the list of errors
+def errorList(mask):
+  return [i for i in range(1,16) if mask & (1 << i)]
+
+class Message:
+  def __init__(self, code, name, fields, binary):
+    self.code   = code   # Code of the message (ocode)
+    self.name   = name   # Name of the code in the message table
+    self.fields = fields # Values of the fields
+    self.binary = binary # True if received as a binary frame
+
+  def __repr__(self):
+    return "<%s(%d)%s>" % (self.name, self.code, "".join(","+str(v) for v in self.fields))
+
+class Decoder:
+  def __init__(self, table=None):
+    self.table  = table if table is not None else loadMessageTable()
+    self.buffer = bytearray()
+    self.numberOfCrcErrors = 0
+
+  # Appends the bytes to the input stream and returns the messages found
+  def feed(self, data):
+    self.buffer += data
+    messages = []
+    while True:
+      message, consumed = self.next()
+      if consumed == 0:
+        break
+      del self.buffer[:consumed]
+      if message is not None:
+        messages.append(message)
+    return messages
+
+  # Returns the next message of the buffer and the number of bytes consumed (0 if more bytes are required)
+  def next(self):
+    buf = self.buffer
+    if len(buf) == 0:
+      return None, 0
+
+    if buf[0] == sync:
+      if len(buf) < 3:
+        return None, 0
+      code, length = buf[1], buf[2]
+      if len(buf) < 5+length:
+        return None, 0
+      payload = bytes(buf[3:3+length])
+      crc = buf[3+length] | (buf[4+length] << 8)
+      if crc16(bytes(buf[1:3+length])) != crc:
+        # Not a valid frame: the sync byte is skipped
+        self.numberOfCrcErrors += 1
+        return None, 1
+      return self.decodeBinary(code, payload), 5+length
+
+    if buf[0] == ord('<'):
+      end = -1
+      for i in range(1,len(buf)):
+        if buf[i] == ord('>'):
+          end = i
+          break
+        if buf[i] == ord('<') or buf[i] == sync:
+          # Incomplete message, resyncing
+          return None, i
+      if end < 0:
+        return None, 0
+      text = bytes(buf[1:end]).decode('ascii','replace').replace('\r','').replace('\n','')
+      return self.decodeAscii(text), end+1
+
+    # Other bytes (new lines, garbage) are skipped
+    return None, 1
+
+  # Expands the format of a message (see the '*' type) for n fields or for the payload size
+  # Each type is a format character, followed by the number of decimals of fixed-point fields (e.g. i2)
+  def types(self, fmt, n=None, size=None):
+    types = []
+    repeat = None
+    for t in fmt:
+      if t == '*':
+        repeat = types[-1]
+        break
+      if t.isdigit():
+        types[-1] += t
+      else:
+        types.append(t)
+    if repeat is not None:
+      if n is not None:
+        while len(types) < n:
+          types.append(repeat)
+      elif size is not None:
+        while sum(fieldSize.get(t[0],0) for t in types) < size:
+          types.append(repeat)
+    return types
+
+  # Converts a fixed-point value of the type (e.g. i2) to float
+  def fixedPoint(self, value, t):
+    return value/10**int(t[1:]) if len(t) > 1 else value
+
+  # Converts the fields of the message to the units of the host (see fieldDivisors)
+  def scale(self, name, fields):
+    divisors = fieldDivisors.get(name, ())
+    return [v/d if d != 1 else v for v, d in zip(fields, divisors)] + fields[len(divisors):]
+
+  # Removes the types of the fields absent from the mask (see the type m)
+  def applyMask(self, types, mask):
+    return [t for k, t in enumerate(types) if mask & (1 << k)]
+
+  def decodeAscii(self, text):
+    entries = text.split(",")
+    code = int(entries[0])
+    name, fmt = self.table.get(code, ("unknown", ""))
+    fields = []
+    types = self.types(fmt, n=len(entries)-1)
+    if 'm' in types:
+      k = types.index('m')
+      types = types[:k+1]+self.applyMask(types[k+1:], int(entries[k+1]))
+    for t, entry in zip(types + ['i']*len(entries), entries[1:]):
+      if t == 'f' or len(t) > 1:
+        fields.append(float(entry))
+      elif t in 'cs':
+        fields.append(entry)
+      elif t == 'x':
+        fields.append(bytes.fromhex(entry))
+      elif t == 'E':
+        fields.append([int(e) for e in entry.split(";") if e != "" and e != "0"])
+      else:
+        fields.append(int(entry))
+    return Message(code, name, self.scale(name, fields), False)
+
+  def decodeBinary(self, code, payload):
+    name, fmt = self.table.get(code, ("unknown", ""))
+    fields = []
+    offset = 0
+    types = self.types(fmt, size=len(payload))
+    while types:
+      t = types.pop(0)
+      if t == 'm':
+        types = self.applyMask(types, payload[offset])
+      if t == 's':
+        fields.append(payload[offset:].decode('ascii','replace'))
+        offset = len(payload)
+      elif t == 'x':
+        fields.append(payload[offset:])
+        offset = len(payload)
+      elif t == 'c':
+        fields.append(chr(payload[offset]))
+        offset += 1
+      else:
+        size = fieldSize[t[0]]
+        if offset+size > len(payload):
+          break
+        value = struct.unpack_from('<'+{'E':'H', 'm':'B'}.get(t[0],t[0]), payload, offset)[0]
+        fields.append(errorList(value) if t == 'E' else self.fixedPoint(value, t))
+        offset += size
+    return Message(code, name, self.scale(name, fields), True)
+
+# Returns an ASCII command <code,values...>
+def command(code, *values):
+  return ("<"+",".join(str(v) for v in (code,)+values)+">").encode('ascii')
+
+# Returns the command that sets all the flight parameters at once (icode 20), with its CRC
+def setFlightParametersCommand(values):
+  crc = crc16(struct.pack('<%dh' % len(values), *values))
+  return command(20, *(list(values)+[crc]))
+
+if __name__ == "__main__":
+  if len(sys.argv) != 2:
+    print("Usage: python "+sys.argv[0]+" <capture file>")
+    exit()
+  decoder = Decoder()
+  with open(sys.argv[1],"rb") as f:
+    for message in decoder.feed(f.read()):
+      print(("B " if message.binary else "A ")+repr(message))
+  if decoder.numberOfCrcErrors > 0:
+    print("CRC errors: "+str(decoder.numberOfCrcErrors))